@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "sparseMatrix.hpp"
+#include "transitionMatrix.hpp"
+#include "sccSolver.hpp"
+
+class AbsorptionTimeDistribution {
+    /* distribution of the game length T (turns until the winning block)
+     from one start block.
+     One sweep of pi(k + 1) = pi(k) Q over the transient blocks gives
+        P(T = k + 1) = pi(k) R,   P(T > k) = sum of pi(k)
+     and, since the expected time left from block i is t_i,
+        E[T - k | T > k] = pi(k) t / P(T > k)
+     so the PMF, CDF and conditional remaining time come out of the same
+     O(steps * nnz) pass, which stops once the surviving mass drops below
+     the tail tolerance. The moments are exact rather than summed from
+     the truncated PMF: t = N 1 and, with s = N t, the variance of every
+     start block is (2N - I) t - t^2 = 2s - t - t*t; both solves go
+     through the block-triangular SCC solver on the sparse I - Q */
+    int start;
+    std::vector<double> pmfValues;      // pmfValues[k] = P(T = k)
+    std::vector<double> cdfValues;      // cdfValues[k] = P(T <= k)
+    std::vector<double> survivalValues; // survivalValues[k] = P(T > k)
+    std::vector<double> remaining;      // remaining[k] = E[T - k | T > k]
+    std::vector<double> expectedMoves;  // t, every transient block
+    std::vector<double> variances;      // Var[T], every transient block
+    bool truncated;
+
+    public:
+    explicit AbsorptionTimeDistribution(const TransitionMatrix& chain, int startBlock = 0,
+        double tailTolerance = 1e-12, int maxSteps = 1000000)
+        : start(startBlock), truncated(false) {
+        const SparseMatrix<double>& P = chain.getSparseTransitionMatrix();
+        const int n = P.getRows() - 1;
+        if (n <= 0)
+            throw std::invalid_argument("Transition matrix has no transient blocks, calculate the probabilities first.");
+        if (start < 0 || start >= n)
+            throw std::out_of_range("Start block must be a transient state.");
+
+        // moments: t = N 1, s = N t
+        const SparseMatrix<double> IMinusQ = chain.getSparseIMinusQ();
+        SCCSolver solver(IMinusQ);
+        expectedMoves = solver.solve(std::vector<double>(n, 1.0));
+        const std::vector<double> s = solver.solve(expectedMoves);
+        variances.resize(n);
+        for (int i = 0; i < n; i++)
+            variances[i] = 2.0 * s[i] - expectedMoves[i] - expectedMoves[i] * expectedMoves[i];
+
+        // one step into the winning block from every transient block
+        const SparseMatrix<double> Q = chain.getSparseQMatrix();
+        std::vector<double> r(n, 0.0);
+        for (int i = 0; i < n; i++)
+            r[i] = P.at(i, n);
+
+        std::vector<double> pi(n, 0.0), next(n);
+        pi[start] = 1.0;
+        pmfValues.push_back(0.0);
+        cdfValues.push_back(0.0);
+        survivalValues.push_back(1.0);
+        remaining.push_back(expectedMoves[start]);
+
+        double absorbed = 0.0;
+        for (int k = 0; k < maxSteps; k++) {
+            double hit = 0.0;
+            for (int i = 0; i < n; i++)
+                hit += pi[i] * r[i];
+            Q.multiplyTranspose(pi.data(), next.data());
+            pi.swap(next);
+
+            double survival = 0.0, left = 0.0;
+            for (int i = 0; i < n; i++) {
+                survival += pi[i];
+                left += pi[i] * expectedMoves[i];
+            }
+            absorbed += hit;
+            pmfValues.push_back(hit);
+            cdfValues.push_back(std::min(1.0, absorbed));
+            // summed directly rather than as 1 - absorbed, which would
+            // cancel catastrophically in the tail
+            survivalValues.push_back(survival);
+            remaining.push_back(survival > 0.0 ? left / survival : 0.0);
+            if (survival <= tailTolerance)
+                return;
+        }
+        truncated = true;
+    }
+
+    // last turn covered by the PMF
+    int horizon() const {
+        return static_cast<int>(pmfValues.size()) - 1;
+    }
+
+    // the sweep hit maxSteps before the tail dropped below the tolerance
+    bool isTruncated() const {
+        return truncated;
+    }
+
+    // beyond the horizon the PMF is treated as 0 (its mass is below the
+    // tail tolerance), the CDF and survival keep their value at the horizon
+    double pmf(int k) const {
+        if (k < 0)
+            throw std::out_of_range("Turn count must not be negative.");
+        return k <= horizon() ? pmfValues[k] : 0.0;
+    }
+
+    double cdf(int k) const {
+        if (k < 0)
+            throw std::out_of_range("Turn count must not be negative.");
+        return cdfValues[std::min(k, horizon())];
+    }
+
+    // P(T > k)
+    double survival(int k) const {
+        if (k < 0)
+            throw std::out_of_range("Turn count must not be negative.");
+        return survivalValues[std::min(k, horizon())];
+    }
+
+    const std::vector<double>& getPMF() const {
+        return pmfValues;
+    }
+
+    const std::vector<double>& getCDF() const {
+        return cdfValues;
+    }
+
+    const std::vector<double>& getSurvival() const {
+        return survivalValues;
+    }
+
+    double mean() const {
+        return expectedMoves[start];
+    }
+
+    double variance() const {
+        return variances[start];
+    }
+
+    double standardDeviation() const {
+        return std::sqrt(std::max(0.0, variance()));
+    }
+
+    // smallest k with P(T <= k) >= p
+    int quantile(double p) const {
+        if (!(p > 0.0 && p <= 1.0))
+            throw std::invalid_argument("Quantile level must lie in (0, 1].");
+        auto it = std::lower_bound(cdfValues.begin(), cdfValues.end(), p);
+        if (it == cdfValues.end())
+            throw std::out_of_range("Quantile lies beyond the computed horizon, lower the tail tolerance.");
+        return static_cast<int>(it - cdfValues.begin());
+    }
+
+    int median() const {
+        return quantile(0.5);
+    }
+
+    // E[T - k | T > k], the expected turns still to play after surviving k
+    double expectedRemaining(int k) const {
+        if (k < 0 || k > horizon())
+            throw std::out_of_range("Turn count must lie within the computed horizon.");
+        return remaining[k];
+    }
+
+    // t and Var[T] for every transient start block
+    const std::vector<double>& getExpectedMoves() const {
+        return expectedMoves;
+    }
+
+    const std::vector<double>& getVariances() const {
+        return variances;
+    }
+
+    int getStartBlock() const {
+        return start;
+    }
+};
@@ -0,0 +1,373 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include "jumpTable.hpp"
+#include "counterRng.hpp"
+#include "simdKernels.hpp"
+#include "moveRules.hpp"
+#include "monteCarloSimulator.hpp"
+
+namespace batch {
+    /* structure-of-arrays state of the games currently in flight, lane i
+     of every array belongs to the same game. Games are identified by a
+     64 bit index: its low half and the turn number form the Philox2x32
+     counter, its high half is folded into the lane key, so the dice of
+     a game only depend on (seed, game index) and not on which lane or
+     thread happens to play it */
+    struct Lanes {
+        std::vector<std::int32_t> position;
+        std::vector<std::int32_t> turns;
+        std::vector<std::uint32_t> gameId;  // low 32 bits of the game index
+        std::vector<std::uint32_t> key;     // seed mixed with the high bits
+        std::vector<std::int32_t> active;   // -1 while a game is running, 0 when idle
+
+        explicit Lanes(int count)
+            : position(count, 0), turns(count, 0), gameId(count, 0), key(count, 0), active(count, 0) {}
+    };
+
+    struct StepArgs {
+        const std::int32_t *table;
+        std::int32_t lastBlock;
+        std::int32_t maxTurns;
+        // per-block hit counters of the calling thread
+        long long *snakeHits;
+        long long *ladderHits;
+    };
+
+    // a token landed on next and was carried to destination; jumps are
+    // rare, so the SIMD kernels hand them over one lane at a time
+    inline void recordJump(const StepArgs& args, int next, int destination) {
+        if (destination < next)
+            args.snakeHits[next]++;
+        else if (destination > next)
+            args.ladderHits[next]++;
+    }
+
+    // advances lanes [begin, end) by one turn and appends the lanes whose
+    // game just ended (won or hit maxTurns) to finished; returns how many
+    using StepKernel = int (*)(Lanes& lanes, int begin, int end, const StepArgs& args, int *finished);
+
+    // SCALAR REFERENCE
+    inline int stepScalar(Lanes& s, int begin, int end, const StepArgs& args, int *finished) {
+        int count = 0;
+        for (int i = begin; i < end; i++) {
+            if (!s.active[i])
+                continue;
+
+            const std::uint32_t bits = philox::philox2x32(s.gameId[i], static_cast<std::uint32_t>(s.turns[i]), s.key[i])[0];
+            const int dice = philox::diceFromBits(bits);
+            const int next = s.position[i] + dice;
+            s.turns[i]++;
+
+            const int destination = rules::moveDestination(s.position[i], dice, args.lastBlock + 1, args.table);
+            // overshooting and winning moves never take a jump
+            if (next < args.lastBlock)
+                recordJump(args, next, destination);
+            s.position[i] = destination;
+
+            if (s.position[i] == args.lastBlock || s.turns[i] >= args.maxTurns)
+                finished[count++] = i;
+        }
+        return count;
+    }
+
+    // appends the set bits of a lane mask as lane indices
+    inline int appendLanes(unsigned mask, int base, int *finished, int count) {
+        while (mask) {
+            finished[count++] = base + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+        return count;
+    }
+
+#if MATRIX_SIMD_X86
+    // AVX2: 8 lanes per register, gather from the destination table
+    namespace avx2 {
+        // high 32 bits of the unsigned products of 8 lanes
+        __attribute__((target("avx2")))
+        inline __m256i mulhi(__m256i a, __m256i b) {
+            const __m256i even = _mm256_mul_epu32(a, b);
+            const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+            return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+        }
+
+        __attribute__((target("avx2")))
+        inline int step(Lanes& s, int begin, int end, const StepArgs& args, int *finished) {
+            const __m256i multiplier = _mm256_set1_epi32(static_cast<int>(philox::M2x32));
+            const __m256i weyl = _mm256_set1_epi32(static_cast<int>(philox::W32_0));
+            const __m256i six = _mm256_set1_epi32(6);
+            const __m256i one = _mm256_set1_epi32(1);
+            const __m256i lastBlock = _mm256_set1_epi32(args.lastBlock);
+            const __m256i pastLast = _mm256_set1_epi32(args.lastBlock + 1);
+            const __m256i turnLimit = _mm256_set1_epi32(args.maxTurns - 1);
+
+            int count = 0;
+            int i = begin;
+            for (; i + 8 <= end; i += 8) {
+                const __m256i active = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s.active[i]));
+                if (_mm256_testz_si256(active, active))
+                    continue;
+
+                __m256i position = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s.position[i]));
+                __m256i turns = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s.turns[i]));
+
+                // Philox2x32-10 on 8 counters at once
+                __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s.gameId[i]));
+                __m256i c1 = turns;
+                __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s.key[i]));
+                for (int r = 0; r < philox::ROUNDS; r++) {
+                    const __m256i hi = mulhi(multiplier, c0);
+                    const __m256i lo = _mm256_mullo_epi32(multiplier, c0);
+                    c0 = _mm256_xor_si256(_mm256_xor_si256(hi, key), c1);
+                    c1 = lo;
+                    key = _mm256_add_epi32(key, weyl);
+                }
+                const __m256i dice = _mm256_add_epi32(mulhi(c0, six), one);
+
+                const __m256i next = _mm256_add_epi32(position, dice);
+                // lanes that overshoot (or are idle) keep their block, lanes on
+                // the winning block stay there, only the others gather a jump
+                const __m256i moved = _mm256_and_si256(active, _mm256_cmpgt_epi32(pastLast, next));
+                const __m256i valid = _mm256_and_si256(active, _mm256_cmpgt_epi32(lastBlock, next));
+                const __m256i index = _mm256_blendv_epi8(position, next, moved);
+                const __m256i destination = _mm256_mask_i32gather_epi32(index, args.table, index, valid, 4);
+
+                const __m256i jumped = _mm256_and_si256(valid,
+                    _mm256_xor_si256(_mm256_cmpeq_epi32(next, destination), _mm256_set1_epi32(-1)));
+                unsigned jumpMask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(jumped)));
+                if (jumpMask) {
+                    alignas(32) std::int32_t nextLanes[8], destinationLanes[8];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(nextLanes), next);
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(destinationLanes), destination);
+                    for (; jumpMask; jumpMask &= jumpMask - 1) {
+                        const int lane = __builtin_ctz(jumpMask);
+                        recordJump(args, nextLanes[lane], destinationLanes[lane]);
+                    }
+                }
+
+                position = destination;
+                turns = _mm256_sub_epi32(turns, active); // active lanes are -1
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&s.position[i]), position);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&s.turns[i]), turns);
+
+                const __m256i done = _mm256_and_si256(active,
+                    _mm256_or_si256(_mm256_cmpeq_epi32(position, lastBlock), _mm256_cmpgt_epi32(turns, turnLimit)));
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(done)));
+                count = appendLanes(mask, i, finished, count);
+            }
+
+            // remainder lanes
+            return count + stepScalar(s, i, end, args, finished + count);
+        }
+    }
+
+    // AVX-512F: 16 lanes per register, masked gather and mask registers
+    // for the active / finished lanes
+    namespace avx512 {
+        __attribute__((target("avx512f")))
+        inline __m512i mulhi(__m512i a, __m512i b) {
+            // maskz forms with a full mask: same result, but avoids GCC's
+            // _mm512_undefined_* maybe-uninitialized false positives
+            const __mmask8 all = 0xFF;
+            const __m512i even = _mm512_maskz_mul_epu32(all, a, b);
+            const __m512i odd = _mm512_maskz_mul_epu32(all, _mm512_maskz_srli_epi64(all, a, 32), _mm512_maskz_srli_epi64(all, b, 32));
+            return _mm512_mask_blend_epi32(static_cast<__mmask16>(0xAAAA), _mm512_maskz_srli_epi64(all, even, 32), odd);
+        }
+
+        __attribute__((target("avx512f")))
+        inline int step(Lanes& s, int begin, int end, const StepArgs& args, int *finished) {
+            const __m512i multiplier = _mm512_set1_epi32(static_cast<int>(philox::M2x32));
+            const __m512i weyl = _mm512_set1_epi32(static_cast<int>(philox::W32_0));
+            const __m512i six = _mm512_set1_epi32(6);
+            const __m512i one = _mm512_set1_epi32(1);
+            const __m512i lastBlock = _mm512_set1_epi32(args.lastBlock);
+            const __m512i maxTurns = _mm512_set1_epi32(args.maxTurns);
+
+            int count = 0;
+            int i = begin;
+            for (; i + 16 <= end; i += 16) {
+                const __mmask16 active = _mm512_test_epi32_mask(_mm512_loadu_si512(&s.active[i]), _mm512_loadu_si512(&s.active[i]));
+                if (active == 0)
+                    continue;
+
+                __m512i position = _mm512_loadu_si512(&s.position[i]);
+                __m512i turns = _mm512_loadu_si512(&s.turns[i]);
+
+                __m512i c0 = _mm512_loadu_si512(&s.gameId[i]);
+                __m512i c1 = turns;
+                __m512i key = _mm512_loadu_si512(&s.key[i]);
+                for (int r = 0; r < philox::ROUNDS; r++) {
+                    const __m512i hi = mulhi(multiplier, c0);
+                    const __m512i lo = _mm512_mullo_epi32(multiplier, c0);
+                    c0 = _mm512_xor_si512(_mm512_xor_si512(hi, key), c1);
+                    c1 = lo;
+                    key = _mm512_add_epi32(key, weyl);
+                }
+                const __m512i dice = _mm512_add_epi32(mulhi(c0, six), one);
+
+                const __m512i next = _mm512_add_epi32(position, dice);
+                // as in the AVX2 kernel: the winning block is never looked up
+                const __mmask16 moved = _mm512_mask_cmple_epi32_mask(active, next, lastBlock);
+                const __mmask16 valid = _mm512_mask_cmplt_epi32_mask(active, next, lastBlock);
+                const __m512i index = _mm512_mask_blend_epi32(moved, position, next);
+                const __m512i destination = _mm512_mask_i32gather_epi32(index, valid, next, args.table, 4);
+
+                unsigned jumpMask = _mm512_mask_cmpneq_epi32_mask(valid, destination, next);
+                if (jumpMask) {
+                    alignas(64) std::int32_t nextLanes[16], destinationLanes[16];
+                    _mm512_store_si512(nextLanes, next);
+                    _mm512_store_si512(destinationLanes, destination);
+                    for (; jumpMask; jumpMask &= jumpMask - 1) {
+                        const int lane = __builtin_ctz(jumpMask);
+                        recordJump(args, nextLanes[lane], destinationLanes[lane]);
+                    }
+                }
+
+                position = destination;
+                turns = _mm512_mask_add_epi32(turns, active, turns, one);
+                _mm512_storeu_si512(&s.position[i], position);
+                _mm512_storeu_si512(&s.turns[i], turns);
+
+                const __mmask16 done = _mm512_mask_cmpeq_epi32_mask(active, position, lastBlock)
+                    | _mm512_mask_cmpge_epi32_mask(active, turns, maxTurns);
+                count = appendLanes(static_cast<unsigned>(done), i, finished, count);
+            }
+
+            return count + stepScalar(s, i, end, args, finished + count);
+        }
+    }
+#endif
+
+    inline StepKernel kernelFor(simd::Level level) {
+#if MATRIX_SIMD_X86
+        if (level == simd::Level::AVX512)
+            return avx512::step;
+        if (level == simd::Level::AVX2 || level == simd::Level::SSE2) {
+            // SSE2 has no gather, its hosts get the AVX2 kernel only if they have it
+            if (simd::detectLevel() >= simd::Level::AVX2)
+                return avx2::step;
+        }
+#endif
+        (void)level;
+        return stepScalar;
+    }
+}
+
+class BatchSimulator {
+    /* lockstep simulator: every thread keeps `laneCount` games in flight
+     as structure-of-arrays state and advances all of them one turn per
+     sweep with the SIMD step kernel (counter-based dice, gather from
+     the jump table). Lanes whose game ends are retired and immediately
+     refilled with the next game index so the vectors stay full.
+     Same rules and same result type as MonteCarloSimulator */
+    const JumpTable& jumps;
+    int laneCount;
+    int maxTurns;
+    batch::StepKernel kernel;
+
+    SimulationResult playRange(std::uint64_t firstGame, std::uint64_t endGame, std::uint64_t seed) const {
+        SimulationResult result;
+        batch::Lanes lanes(laneCount);
+        std::vector<int> finished(laneCount);
+        result.snakeHits.assign(jumps.size(), 0);
+        result.ladderHits.assign(jumps.size(), 0);
+        const batch::StepArgs args{jumps.data(), jumps.size() - 1, maxTurns,
+            result.snakeHits.data(), result.ladderHits.data()};
+        const std::uint32_t baseKey = philox::foldSeed(seed);
+
+        std::uint64_t nextGame = firstGame;
+        double mean = 0.0, m2 = 0.0;
+        long long won = 0;
+        int running = 0;
+
+        auto startGame = [&](int lane) {
+            if (nextGame >= endGame) {
+                lanes.active[lane] = 0;
+                return;
+            }
+            lanes.position[lane] = 0;
+            lanes.turns[lane] = 0;
+            lanes.gameId[lane] = static_cast<std::uint32_t>(nextGame);
+            lanes.key[lane] = baseKey + static_cast<std::uint32_t>(nextGame >> 32) * philox::W32_1;
+            lanes.active[lane] = -1;
+            nextGame++;
+            running++;
+        };
+
+        for (int lane = 0; lane < laneCount; lane++)
+            startGame(lane);
+
+        while (running > 0) {
+            const int count = kernel(lanes, 0, laneCount, args, finished.data());
+
+            // masked retirement: record the finished lanes and refill them
+            for (int k = 0; k < count; k++) {
+                const int lane = finished[k];
+                const int turns = lanes.turns[lane];
+                running--;
+
+                if (lanes.position[lane] != args.lastBlock) {
+                    result.truncatedGames++;
+                } else {
+                    won++;
+                    const double delta = turns - mean;
+                    mean += delta / won;
+                    m2 += delta * (turns - mean);
+                    if (static_cast<int>(result.lengthHistogram.size()) <= turns)
+                        result.lengthHistogram.resize(turns + 1, 0);
+                    result.lengthHistogram[turns]++;
+                }
+                startGame(lane);
+            }
+        }
+
+        for (int block = 0; block < jumps.size(); block++) {
+            result.totalSnakeHits += result.snakeHits[block];
+            result.totalLadderHits += result.ladderHits[block];
+        }
+        result.games = won;
+        result.meanLength = mean;
+        result.varianceLength = won > 0 ? m2 / won : 0.0;
+        return result;
+    }
+
+    public:
+    // the jump table must outlive the simulator
+    explicit BatchSimulator(const JumpTable& table, int lanesPerThread = 4096, int maxTurnsPerGame = 100000)
+        : jumps(table), laneCount(lanesPerThread), maxTurns(maxTurnsPerGame),
+        kernel(batch::kernelFor(simd::detectLevel())) {}
+
+    // forces a kernel, e.g. simd::Level::Scalar to verify the SIMD paths
+    void setLevel(simd::Level level) {
+        kernel = batch::kernelFor(std::min(level, simd::detectLevel()));
+    }
+
+    // plays game indices [0, games); results only depend on the seed, not
+    // on the number of threads or lanes (up to floating point rounding of
+    // the mean and variance)
+    SimulationResult run(std::uint64_t games, std::uint64_t seed, int threads = 0) const {
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        std::vector<SimulationResult> partial(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (int t = 0; t < threads; t++) {
+            const std::uint64_t first = games * t / threads;
+            const std::uint64_t last = games * (t + 1) / threads;
+            workers.emplace_back([this, &partial, first, last, seed, t]() {
+                partial[t] = playRange(first, last, seed);
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        SimulationResult result;
+        for (const SimulationResult& part : partial)
+            result.merge(part);
+        return result;
+    }
+};
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "batchSimulator.hpp"
+#include "monteCarloSimulator.hpp"
+#include "canonicalBoards.hpp"
+
+// single-thread throughput of the BatchSimulator step kernels and of the
+// per-game MonteCarloSimulator on the classic board, in dice moves per
+// second (every turn of every game is one move).
+// build and run with `make bench`
+
+using Clock = std::chrono::steady_clock;
+
+// turns played in total, the won games from the histogram plus the
+// truncated ones at the turn limit
+long long movesPlayed(const SimulationResult& result, int maxTurns) {
+    long long moves = result.truncatedGames * static_cast<long long>(maxTurns);
+    for (size_t turns = 0; turns < result.lengthHistogram.size(); turns++)
+        moves += static_cast<long long>(turns) * result.lengthHistogram[turns];
+    return moves;
+}
+
+template <class Run>
+void report(const char *name, int maxTurns, Run run) {
+    const Clock::time_point start = Clock::now();
+    const SimulationResult result = run();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const long long moves = movesPlayed(result, maxTurns);
+    std::cout << std::setw(20) << name << std::fixed << std::setprecision(1)
+              << std::setw(12) << moves / seconds * 1e-6 << "M moves/s"
+              << std::setprecision(4) << "   mean length " << result.meanLength << "\n";
+}
+
+int main() {
+    const JumpTable jumps = boards::toJumpTable<100>(boards::classicJumps);
+    const long long games = 2000000;
+    const int maxTurns = 100000;
+    const std::uint64_t seed = 2024;
+
+    std::cout << "classic board, " << games << " games, 1 thread, detected "
+              << simd::levelName(simd::detectLevel()) << "\n";
+
+    BatchSimulator batch(jumps, 4096, maxTurns);
+    for (simd::Level level : {simd::Level::Scalar, simd::Level::AVX2, simd::Level::AVX512}) {
+        if (level > simd::detectLevel())
+            continue;
+        batch.setLevel(level);
+        const std::string name = std::string("batch ") + simd::levelName(level);
+        report(name.c_str(), maxTurns, [&]() { return batch.run(games, seed, 1); });
+    }
+
+    MonteCarloSimulator perGame(jumps, maxTurns);
+    report("per-game Philox", maxTurns, [&]() { return perGame.run(games, seed, 1); });
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "matrix.hpp"
+
+// Matrix * Matrix (packed, blocked GEMM) against the plain i-k-j loop of
+// gemm::naive on square n x n operands, best of a few repetitions.
+// build and run with `make bench`
+
+using Clock = std::chrono::steady_clock;
+
+template <class Work>
+double bestSeconds(int repetitions, Work work) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; r++) {
+        const Clock::time_point start = Clock::now();
+        work();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+int main() {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+    const std::vector<simd::Level> levels = {simd::Level::Scalar, simd::Level::AVX2, simd::Level::AVX512};
+
+    std::cout << "detected: " << simd::levelName(simd::detectLevel()) << "\n";
+    std::cout << std::setw(6) << "n" << std::setw(10) << "level" << std::setw(12) << "naive GF/s"
+              << std::setw(12) << "gemm GF/s" << std::setw(10) << "speedup" << "\n";
+
+    for (int n : {256, 512, 1000}) {
+        Matrix<double> A(n, n), B(n, n);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                A[i][j] = dis(gen);
+                B[i][j] = dis(gen);
+            }
+        }
+        const double flops = 2.0 * n * n * n;
+        const int repetitions = n >= 1000 ? 3 : 5;
+
+        for (simd::Level level : levels) {
+            if (level > simd::detectLevel())
+                continue;
+            simd::setLevel(level);
+
+            Matrix<double> C(n, n, 0.0);
+            const double naive = bestSeconds(repetitions, [&]() {
+                std::fill(C.getData(), C.getData() + static_cast<long>(n) * C.getStride(), 0.0);
+                gemm::naive(n, n, n, A.getData(), A.getStride(), B.getData(), B.getStride(), C.getData(), C.getStride());
+            });
+            Matrix<double> D;
+            const double blocked = bestSeconds(repetitions, [&]() { D = A * B; });
+
+            double error = 0.0;
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < n; j++)
+                    error = std::max(error, std::abs(C[i][j] - D[i][j]));
+            if (error > 1e-9 * n) {
+                std::cerr << "GEMM and naive results differ by " << error << "\n";
+                return 1;
+            }
+
+            std::cout << std::setw(6) << n << std::setw(10) << simd::levelName(level)
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(12) << flops / naive * 1e-9 << std::setw(12) << flops / blocked * 1e-9
+                      << std::setw(9) << naive / blocked << "x\n";
+        }
+    }
+    return 0;
+}
@@ -5,11 +5,14 @@
 #include "boardEntity.hpp"
 #include "snake.hpp"
 #include "ladder.hpp"
+#include "jumpTable.hpp"
 
 class Board {
     // board is a 2D vector of size length x height
     std::vector<std::vector<BoardEntity*>> board;
     const int snakesCount, ladderCount, boardLength, boardHeight;
+    // flat destination per block, built once the board is placed
+    JumpTable jumps;
     
     double getSnakeProbability(const int currBlock, const int totalBlocks) {
         // lower probability of placement at the start & higher at the end
@@ -24,9 +27,18 @@ class Board {
         return p;
     }
 
+    // process-wide generator of the boards built without an explicit one
+    static std::mt19937& defaultGenerator() {
+        static std::random_device rd;
+        static std::mt19937 gen(rd());
+        return gen;
+    }
+
+    template <class Generator>
     void initialiseBoard(
         int snakesCount, int ladderCount,
-        const int boardLength, const int boardHeight
+        const int boardLength, const int boardHeight,
+        Generator& gen
     ) {
         
         // not all snakes & ladders are placed to prevent board from becoming overcrowded
@@ -41,9 +53,7 @@ class Board {
         // 4. longest snake no more than 90% of total blocks
         // 5. no snakes / ladders at the starting block
 
-        // random number generator and distribution
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
+        // placement distribution, gen decides the board completely
         std::uniform_real_distribution<> dis(0.0, 1.0);
 
         for (int i = 0; i < boardHeight; i++) {
@@ -123,12 +133,28 @@ class Board {
 
     public:
     Board(const int snakes, const int ladders, int length, int height)
-        : snakesCount(snakes), ladderCount(ladders), boardLength(length), boardHeight(height),
-        board(height, std::vector<BoardEntity*>(length, nullptr)) {
-        
-        initialiseBoard(snakes, ladders, length, height);
+        : Board(snakes, ladders, length, height, defaultGenerator()) {}
+
+    // same board for the same generator state, e.g. a PhiloxEngine stream
+    template <class Generator>
+    Board(const int snakes, const int ladders, int length, int height, Generator& gen)
+        : board(height, std::vector<BoardEntity*>(length, nullptr)),
+        snakesCount(snakes), ladderCount(ladders), boardLength(length), boardHeight(height) {
+
+        initialiseBoard(snakes, ladders, length, height, gen);
+        jumps = JumpTable::fromGrid(board, boardLength);
+    }
+
+    // the board owns its snakes and ladders
+    ~Board() {
+        for (auto& row : board)
+            for (BoardEntity *entity : row)
+                delete entity;
     }
 
+    Board(const Board&) = delete;
+    Board& operator=(const Board&) = delete;
+
     void displayBoard() {
         for (size_t i = 0; i < board.size(); ++i) {
             for (size_t j = 0; j < board[i].size(); ++j) {
@@ -146,10 +172,14 @@ class Board {
         }
     }
     
-    std::vector<std::vector<BoardEntity*>> getBoard() const {
+    const std::vector<std::vector<BoardEntity*>>& getBoard() const {
         return board;
     }
 
+    const JumpTable& getJumpTable() const {
+        return jumps;
+    }
+
     const int getLength() const {
         return boardLength;
     }
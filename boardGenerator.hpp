@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "board.hpp"
+#include "jumpTable.hpp"
+#include "counterRng.hpp"
+
+class BoardGenerator {
+    /* reproducible random boards in bulk. Board i of a corpus is placed
+     by Board::initialiseBoard driven by PhiloxEngine(masterSeed, i), a
+     counter-based stream keyed by the board index, so
+       - any board can be regenerated on its own from (seed, index)
+       - the corpus does not depend on the number of threads or on the
+         order in which boards are produced
+       - threads share nothing but the read-only settings
+     (the placement draws go through the standard distributions, so a
+     corpus is reproducible for a given standard library) */
+    int snakes, ladders, length, height;
+    std::uint64_t masterSeed;
+
+    static int resolveThreads(int threads, long long count) {
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        return static_cast<int>(std::min<long long>(threads, std::max(1LL, count)));
+    }
+
+    public:
+    BoardGenerator(int snakesCount, int ladderCount, int boardLength, int boardHeight, std::uint64_t seed)
+        : snakes(snakesCount), ladders(ladderCount), length(boardLength), height(boardHeight), masterSeed(seed) {
+        if (length <= 0 || height <= 0)
+            throw std::invalid_argument("Board dimensions must be positive.");
+    }
+
+    // board number index of the corpus
+    JumpTable generate(long long index) const {
+        if (index < 0)
+            throw std::out_of_range("Board index must not be negative.");
+        PhiloxEngine stream(masterSeed, static_cast<std::uint64_t>(index));
+        Board board(snakes, ladders, length, height, stream);
+        return board.getJumpTable();
+    }
+
+    // calls visit(index, board) for boards first .. first + count - 1;
+    // every thread takes a contiguous range, visit runs concurrently on
+    // different boards and must be thread safe
+    template <class Visitor>
+    void forEach(long long first, long long count, Visitor visit, int threads = 0) const {
+        if (count <= 0)
+            return;
+        // checked here, an exception inside a worker would end the process
+        if (first < 0)
+            throw std::out_of_range("Board index must not be negative.");
+        threads = resolveThreads(threads, count);
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (int t = 0; t < threads; t++) {
+            // spread the remainder over the first threads
+            const long long begin = first + count / threads * t + std::min<long long>(t, count % threads);
+            const long long share = count / threads + (t < count % threads ? 1 : 0);
+            workers.emplace_back([this, begin, share, &visit]() {
+                for (long long i = begin; i < begin + share; i++)
+                    visit(i, generate(i));
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    // boards first .. first + count - 1, result[k] is board first + k
+    std::vector<JumpTable> generateBatch(long long first, long long count, int threads = 0) const {
+        std::vector<JumpTable> boards(std::max(0LL, count));
+        forEach(first, count, [&](long long index, JumpTable board) {
+            boards[index - first] = std::move(board);
+        }, threads);
+        return boards;
+    }
+
+    std::uint64_t getSeed() const {
+        return masterSeed;
+    }
+};
@@ -0,0 +1,377 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "jumpTable.hpp"
+#include "counterRng.hpp"
+#include "incrementalAnalysis.hpp"
+
+struct OptimizerTarget {
+    double expectedMoves;           // from the starting block
+    double variance;                // of the game length
+    double varianceWeight = 1.0;    // 0 ignores the variance
+    double tolerance = 0.02;        // relative band that counts as a hit
+};
+
+struct OptimizerOptions {
+    int iterations = 20000;         // candidate evaluations per search / replica
+    double initialTemperature = 0.1;
+    double finalTemperature = 1e-4;
+    int tabuTenure = 16;            // iterations a vacated block stays tabu
+    int neighbourhood = 24;         // candidates compared per tabu step
+    int replicas = 0;               // parallel tempering, 0 = max(4, cores)
+    int swapInterval = 100;         // steps between replica exchanges
+    std::uint64_t seed = 1;
+};
+
+struct OptimizerResult {
+    JumpTable board;
+    double expectedMoves = 0.0;
+    double variance = 0.0;
+    double cost = std::numeric_limits<double>::infinity();
+    long long evaluations = 0;
+    bool reachedTarget = false;
+};
+
+class BoardOptimizer {
+    /* searches for a board whose expected game length and variance hit
+     a target, keeping the number of snakes and ladders of the starting
+     board and the placement rules of Board::initialiseBoard:
+       - nothing starts on the first or the last block
+       - a block is the start or end of at most one snake / ladder
+       - no two starts are horizontal neighbours in the same row
+       - ladders go up, snakes go down by at most 90% of the board
+     A move either re-targets one jump or shifts it to a new start with
+     the same length. Candidates are scored through IncrementalAnalysis,
+     so a move is one or two rank-one updates of N (O(S^2)) instead of a
+     new factorization, and the length statistics of block 0 are
+        mean = t_0,  variance = (2 N t - t - t*t)_0
+     which is O(S) once N and t are current. The cost is the weighted
+     squared relative error of both */
+    int length, height, totalBlocks;
+    OptimizerTarget target;
+    OptimizerOptions options;
+
+    struct Mutation {
+        int start = -1, end = -1;       // jump before the move
+        int newStart = -1, newEnd = -1; // jump after the move
+    };
+
+    struct Chain {
+        IncrementalAnalysis analysis;
+        double mean, variance, cost;
+        OptimizerResult best;
+    };
+
+    bool occupiedBy(const JumpTable& table, int block, int ignore) const {
+        for (int b = 1; b < totalBlocks - 1; b++) {
+            if (b != ignore && table.hasJump(b) && (b == block || table[b] == block))
+                return true;
+        }
+        return false;
+    }
+
+    // whether a jump start -> end of the given kind may replace the jump at ignore
+    bool allowed(const JumpTable& table, int start, int end, EntityKind kind, int ignore) const {
+        if (start <= 0 || start >= totalBlocks - 1 || end < 0 || end >= totalBlocks)
+            return false;
+        if (kind == EntityKind::Ladder && end <= start)
+            return false;
+        if (kind == EntityKind::Snake && (end >= start || start - end > 0.9 * totalBlocks))
+            return false;
+        if (occupiedBy(table, start, ignore) || occupiedBy(table, end, ignore))
+            return false;
+
+        const int column = start % length;
+        if (column > 0 && start - 1 != ignore && table.hasJump(start - 1))
+            return false;
+        if (column < length - 1 && start + 1 != ignore && start + 1 < totalBlocks && table.hasJump(start + 1))
+            return false;
+        return true;
+    }
+
+    static int uniform(PhiloxEngine& rng, int lo, int hi) {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    }
+
+    Mutation propose(const JumpTable& table, PhiloxEngine& rng) const {
+        std::vector<int> starts;
+        for (int b = 1; b < totalBlocks - 1; b++) {
+            if (table.hasJump(b))
+                starts.push_back(b);
+        }
+        Mutation m;
+        if (starts.empty())
+            return m;
+
+        for (int attempt = 0; attempt < 64; attempt++) {
+            const int start = starts[uniform(rng, 0, static_cast<int>(starts.size()) - 1)];
+            const int end = table[start];
+            const EntityKind kind = table.kindAt(start);
+            int newStart = start, newEnd = end;
+
+            if (uniform(rng, 0, 1) == 0) {
+                // re-target
+                newEnd = kind == EntityKind::Ladder
+                    ? uniform(rng, start + 1, totalBlocks - 1)
+                    : uniform(rng, 0, start - 1);
+            } else {
+                // shift, keeping the length
+                newStart = uniform(rng, 1, totalBlocks - 2);
+                newEnd = newStart + (end - start);
+            }
+
+            if ((newStart != start || newEnd != end) && allowed(table, newStart, newEnd, kind, start)) {
+                m.start = start;
+                m.end = end;
+                m.newStart = newStart;
+                m.newEnd = newEnd;
+                return m;
+            }
+        }
+        return m;
+    }
+
+    void measure(Chain& chain) const {
+        const Matrix<double>& N = chain.analysis.getFundamentalMatrix();
+        const Matrix<double>& t = chain.analysis.getExpectedMoves();
+        double Nt = 0.0;
+        for (int j = 0; j < t.getRows(); j++)
+            Nt += N[0][j] * t[j][0];
+        chain.mean = t[0][0];
+        chain.variance = 2.0 * Nt - t[0][0] - t[0][0] * t[0][0];
+        chain.cost = cost(chain.mean, chain.variance);
+    }
+
+    void record(Chain& chain) const {
+        chain.best.evaluations++;
+        if (chain.cost < chain.best.cost) {
+            chain.best.board = chain.analysis.getJumpTable();
+            chain.best.expectedMoves = chain.mean;
+            chain.best.variance = chain.variance;
+            chain.best.cost = chain.cost;
+            chain.best.reachedTarget = meetsTarget(chain.mean, chain.variance);
+        }
+    }
+
+    // applies (or with undo, reverts) a mutation; a failed update leaves
+    // the analysis rebuilt from the board before the move
+    bool apply(Chain& chain, const Mutation& m, bool undo = false) const {
+        const int from = undo ? m.newStart : m.start;
+        const int to = undo ? m.start : m.newStart;
+        const int end = undo ? m.end : m.newEnd;
+        const JumpTable before = chain.analysis.getJumpTable();
+        try {
+            if (from != to)
+                chain.analysis.clearJump(from);
+            chain.analysis.setJump(to, end);
+        } catch (const std::runtime_error&) {
+            chain.analysis = IncrementalAnalysis(before, 256);
+            measure(chain);
+            return false;
+        }
+        measure(chain);
+        return true;
+    }
+
+    Chain makeChain(const JumpTable& start) const {
+        Chain chain{IncrementalAnalysis(start, 256), 0.0, 0.0, 0.0, OptimizerResult()};
+        measure(chain);
+        record(chain);
+        return chain;
+    }
+
+    // one Metropolis step at the given temperature
+    void metropolisStep(Chain& chain, double temperature, PhiloxEngine& rng) const {
+        const Mutation m = propose(chain.analysis.getJumpTable(), rng);
+        if (m.start < 0)
+            return;
+        const double before = chain.cost;
+        if (!apply(chain, m))
+            return;
+        record(chain);
+
+        const double delta = chain.cost - before;
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        if (delta > 0.0 && u >= std::exp(-delta / temperature))
+            apply(chain, m, true);
+    }
+
+    void checkStart(const JumpTable& start) const {
+        if (start.size() != totalBlocks)
+            throw std::invalid_argument("Starting board does not match the board dimensions.");
+        bool anyJump = false;
+        for (int b = 1; b < totalBlocks - 1; b++) {
+            if (start.hasJump(b))
+                anyJump = true;
+        }
+        if (!anyJump)
+            throw std::invalid_argument("Starting board needs at least one snake or ladder to move.");
+        if (!isValid(start))
+            throw std::invalid_argument("Starting board breaks the placement rules.");
+    }
+
+    public:
+    BoardOptimizer(int boardLength, int boardHeight, OptimizerTarget goal, OptimizerOptions settings = OptimizerOptions())
+        : length(boardLength), height(boardHeight), totalBlocks(boardLength * boardHeight),
+        target(goal), options(settings) {
+        if (length <= 0 || height <= 0 || totalBlocks < 3)
+            throw std::invalid_argument("Board dimensions must be positive.");
+        if (target.expectedMoves <= 0.0 || (target.varianceWeight > 0.0 && target.variance <= 0.0))
+            throw std::invalid_argument("Targets must be positive.");
+    }
+
+    double cost(double mean, double variance) const {
+        const double meanError = (mean - target.expectedMoves) / target.expectedMoves;
+        double c = meanError * meanError;
+        if (target.varianceWeight > 0.0) {
+            const double varianceError = (variance - target.variance) / target.variance;
+            c += target.varianceWeight * varianceError * varianceError;
+        }
+        return c;
+    }
+
+    bool meetsTarget(double mean, double variance) const {
+        if (std::abs(mean - target.expectedMoves) > target.tolerance * target.expectedMoves)
+            return false;
+        return target.varianceWeight <= 0.0 || std::abs(variance - target.variance) <= target.tolerance * target.variance;
+    }
+
+    // every jump obeys the placement rules
+    bool isValid(const JumpTable& table) const {
+        if (table.size() != totalBlocks)
+            return false;
+        for (int b = 0; b < totalBlocks; b++) {
+            if (!table.hasJump(b))
+                continue;
+            if (!allowed(table, b, table[b], table.kindAt(b), b))
+                return false;
+        }
+        return true;
+    }
+
+    // simulated annealing with a geometric cooling schedule
+    OptimizerResult anneal(const JumpTable& start) const {
+        checkStart(start);
+        PhiloxEngine rng(options.seed, 0);
+        Chain chain = makeChain(start);
+
+        const double cooling = std::pow(options.finalTemperature / options.initialTemperature,
+            1.0 / std::max(1, options.iterations - 1));
+        double temperature = options.initialTemperature;
+        for (int it = 0; it < options.iterations && !chain.best.reachedTarget; it++) {
+            metropolisStep(chain, temperature, rng);
+            temperature *= cooling;
+        }
+        return chain.best;
+    }
+
+    // steepest descent over a sampled neighbourhood; blocks a jump was
+    // moved away from may not be reused for tabuTenure steps unless the
+    // move beats the best board found so far (aspiration)
+    OptimizerResult tabuSearch(const JumpTable& start) const {
+        checkStart(start);
+        PhiloxEngine rng(options.seed, 0);
+        Chain chain = makeChain(start);
+        std::vector<int> tabuUntil(totalBlocks, -1);
+
+        const int steps = std::max(1, options.iterations / std::max(1, options.neighbourhood));
+        for (int step = 0; step < steps && !chain.best.reachedTarget; step++) {
+            Mutation chosen;
+            double chosenCost = std::numeric_limits<double>::infinity();
+            for (int c = 0; c < options.neighbourhood; c++) {
+                const Mutation m = propose(chain.analysis.getJumpTable(), rng);
+                if (m.start < 0)
+                    continue;
+                const double bestSoFar = chain.best.cost;
+                if (!apply(chain, m))
+                    continue;
+                record(chain);
+                const double candidate = chain.cost;
+                apply(chain, m, true);
+
+                const bool tabu = m.newStart != m.start && tabuUntil[m.newStart] > step;
+                if ((!tabu || candidate < bestSoFar) && candidate < chosenCost) {
+                    chosen = m;
+                    chosenCost = candidate;
+                }
+            }
+            if (chosen.start < 0)
+                continue;
+            if (apply(chain, chosen) && chosen.newStart != chosen.start)
+                tabuUntil[chosen.start] = step + options.tabuTenure;
+        }
+        return chain.best;
+    }
+
+    // replicas at geometrically spaced temperatures run Metropolis steps
+    // on their own threads and exchange boards between neighbouring
+    // temperatures every swapInterval steps, so hot replicas explore and
+    // cold ones refine. Deterministic for a given seed and replica count
+    OptimizerResult parallelTempering(const JumpTable& start) const {
+        checkStart(start);
+        int replicas = options.replicas;
+        if (replicas <= 0)
+            replicas = std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+
+        std::vector<Chain> chains;
+        std::vector<PhiloxEngine> streams;
+        std::vector<double> temperatures(replicas);
+        chains.reserve(replicas);
+        for (int r = 0; r < replicas; r++) {
+            chains.push_back(makeChain(start));
+            streams.emplace_back(options.seed, static_cast<std::uint64_t>(r));
+            temperatures[r] = replicas == 1 ? options.finalTemperature
+                : options.finalTemperature * std::pow(options.initialTemperature / options.finalTemperature,
+                    static_cast<double>(r) / (replicas - 1));
+        }
+        // slot[k] is the chain currently at temperature k
+        std::vector<int> slot(replicas);
+        for (int r = 0; r < replicas; r++)
+            slot[r] = r;
+        PhiloxEngine exchange(options.seed, static_cast<std::uint64_t>(replicas));
+
+        const int interval = std::max(1, options.swapInterval);
+        bool done = false;
+        for (int it = 0; it < options.iterations && !done; it += interval) {
+            const int steps = std::min(interval, options.iterations - it);
+            std::vector<std::thread> workers;
+            workers.reserve(replicas);
+            for (int k = 0; k < replicas; k++) {
+                workers.emplace_back([&, k]() {
+                    Chain& chain = chains[slot[k]];
+                    for (int s = 0; s < steps && !chain.best.reachedTarget; s++)
+                        metropolisStep(chain, temperatures[k], streams[slot[k]]);
+                });
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+
+            for (int k = 0; k + 1 < replicas; k++) {
+                const Chain& cold = chains[slot[k]];
+                const Chain& hot = chains[slot[k + 1]];
+                const double exponent = (cold.cost - hot.cost) * (1.0 / temperatures[k] - 1.0 / temperatures[k + 1]);
+                const double u = std::uniform_real_distribution<double>(0.0, 1.0)(exchange);
+                if (exponent >= 0.0 || u < std::exp(exponent))
+                    std::swap(slot[k], slot[k + 1]);
+            }
+            for (const Chain& chain : chains)
+                done = done || chain.best.reachedTarget;
+        }
+
+        OptimizerResult best;
+        long long evaluations = 0;
+        for (const Chain& chain : chains) {
+            evaluations += chain.best.evaluations;
+            if (chain.best.cost < best.cost)
+                best = chain.best;
+        }
+        best.evaluations = evaluations;
+        return best;
+    }
+};
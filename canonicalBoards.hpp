@@ -0,0 +1,160 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include "jumpTable.hpp"
+#include "moveRules.hpp"
+
+namespace boards {
+    /* boards that ship with the game, analysed entirely at compile time.
+     A board is a constexpr list of jumps; analyse() builds its
+     transitions (the six dice outcomes of every block), solves
+     (I - Q) t = 1 and evolves the distribution inside a constant
+     expression, so only the results (expected moves from every block
+     and the win-probability curve) end up in the binary and reading
+     them at startup costs nothing. An invalid jump is a compile error */
+
+    struct Jump {
+        int start, end; // 0-based blocks
+    };
+
+    // constexpr counterpart of JumpTable: destination of every block
+    template <int Blocks, std::size_t N>
+    constexpr std::array<int, Blocks> destinations(const std::array<Jump, N>& jumps) {
+        std::array<int, Blocks> table{};
+        for (int i = 0; i < Blocks; i++)
+            table[i] = i;
+        for (const Jump& jump : jumps) {
+            if (jump.start < 0 || jump.start >= Blocks || jump.end < 0 || jump.end >= Blocks)
+                throw std::out_of_range("Jump start and end must lie on the board.");
+            // the token starts on block 0 and never lands there, the last
+            // block wins; a jump on either would be silently ignored
+            if (jump.start == 0 || jump.start == Blocks - 1)
+                throw std::invalid_argument("The start and winning blocks cannot carry a jump.");
+            table[jump.start] = jump.end;
+        }
+        return table;
+    }
+
+    // runtime JumpTable for the same board, e.g. for the simulators
+    template <int Blocks, std::size_t N>
+    JumpTable toJumpTable(const std::array<Jump, N>& jumps) {
+        JumpTable table(Blocks);
+        for (const Jump& jump : jumps)
+            table.setJump(jump.start, jump.end);
+        return table;
+    }
+
+    // dice outcomes of every block under the TransitionMatrix rules:
+    // overshooting stays put, the last block is absorbing
+    template <int Blocks>
+    struct Moves {
+        std::array<std::array<int, 6>, Blocks> to;
+    };
+
+    template <int Blocks>
+    constexpr Moves<Blocks> moves(const std::array<int, Blocks>& destination) {
+        Moves<Blocks> m{};
+        for (int block = 0; block < Blocks; block++) {
+            for (int dice = 1; dice <= 6; dice++)
+                m.to[block][dice - 1] = rules::moveDestination(block, dice, Blocks, destination);
+        }
+        return m;
+    }
+
+    // t = 1 + Q t by Gauss-Seidel sweeps over the blocks in descending
+    // order: dice only move forward, so every sweep is an exact back
+    // substitution apart from the few snakes, and a handful of sweeps
+    // reach the fixed point. A dense elimination of the 99 x 99 system
+    // would exceed the compiler's constexpr operation budget
+    template <int Blocks>
+    constexpr std::array<double, Blocks - 1> expectedMoves(const Moves<Blocks>& m) {
+        std::array<double, Blocks - 1> t{};
+        for (int sweep = 0; sweep < 100000; sweep++) {
+            double change = 0.0, largest = 0.0;
+            for (int i = Blocks - 2; i >= 0; i--) {
+                double stay = 0.0, sum = 1.0;
+                for (int d = 0; d < 6; d++) {
+                    const int j = m.to[i][d];
+                    if (j == i)
+                        stay += 1.0 / 6.0;
+                    else if (j != Blocks - 1)
+                        sum += t[j] / 6.0;
+                }
+                if (stay == 1.0)
+                    throw std::runtime_error("Block can never reach the winning block.");
+                const double updated = sum / (1.0 - stay);
+                const double delta = updated > t[i] ? updated - t[i] : t[i] - updated;
+                change = delta > change ? delta : change;
+                largest = updated > largest ? updated : largest;
+                t[i] = updated;
+            }
+            if (change <= 1e-15 * largest)
+                return t;
+        }
+        throw std::runtime_error("Expected moves did not converge.");
+    }
+
+    // probability of having won within k turns from block 0, k = 0 .. Steps
+    template <int Steps, int Blocks>
+    constexpr std::array<double, Steps + 1> winProbabilities(const Moves<Blocks>& m) {
+        std::array<double, Steps + 1> win{};
+        std::array<double, Blocks> current{}, next{};
+        current[0] = 1.0;
+        for (int k = 1; k <= Steps; k++) {
+            for (int j = 0; j < Blocks; j++)
+                next[j] = 0.0;
+            for (int i = 0; i < Blocks; i++) {
+                if (current[i] == 0.0)
+                    continue;
+                if (i == Blocks - 1) {
+                    next[i] += current[i];
+                    continue;
+                }
+                for (int d = 0; d < 6; d++)
+                    next[m.to[i][d]] += current[i] / 6.0;
+            }
+            current = next;
+            win[k] = current[Blocks - 1];
+        }
+        return win;
+    }
+
+    template <int Length, int Height, int Steps>
+    struct Analysis {
+        static constexpr int States = Length * Height;
+
+        // expected moves to win from each transient block
+        std::array<double, States - 1> expectedMoves;
+        // probability of having won within k turns from block 0, k = 0 .. Steps
+        std::array<double, Steps + 1> winProbability;
+    };
+
+    template <int Length, int Height, int Steps, std::size_t N>
+    constexpr Analysis<Length, Height, Steps> analyse(const std::array<Jump, N>& jumps) {
+        constexpr int Blocks = Length * Height;
+        const Moves<Blocks> m = moves<Blocks>(destinations<Blocks>(jumps));
+        Analysis<Length, Height, Steps> result{};
+        result.expectedMoves = expectedMoves<Blocks>(m);
+        result.winProbability = winProbabilities<Steps, Blocks>(m);
+        return result;
+    }
+
+    // the classic 10 x 10 Milton Bradley layout (squares 1..100 shifted to
+    // 0..99). Here the token starts on square 1 instead of off the board,
+    // so the ladder 1 -> 38, which only a first roll of 1 from off the
+    // board could take, is left out; the figures are for this rule set,
+    // not the original game's
+    inline constexpr std::array<Jump, 18> classicJumps = {{
+        // ladders
+        {3, 13}, {8, 30}, {20, 41}, {27, 83}, {35, 43}, {50, 66}, {70, 90}, {79, 99},
+        // snakes
+        {15, 5}, {46, 25}, {48, 10}, {55, 52}, {61, 18}, {63, 59}, {86, 23}, {92, 72}, {94, 74}, {97, 77}
+    }};
+
+    // no snakes or ladders, the baseline every layout is compared with
+    inline constexpr std::array<Jump, 0> emptyJumps = {};
+
+    inline constexpr Analysis<10, 10, 100> classic = analyse<10, 10, 100>(classicJumps);
+    inline constexpr Analysis<10, 10, 100> empty = analyse<10, 10, 100>(emptyJumps);
+}
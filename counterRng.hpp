@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <limits>
+
+namespace philox {
+    /* Philox counter-based generators (Salmon et al., "Parallel random
+     numbers: as easy as 1, 2, 3"). The output is a pure function of
+     (counter, key), so any stream position can be computed directly,
+     streams never need to be stored or advanced in order, and lanes or
+     threads that use distinct counters are independent */
+
+    constexpr std::uint32_t M2x32 = 0xD256D193u;
+    constexpr std::uint32_t M4x32_0 = 0xD2511F53u;
+    constexpr std::uint32_t M4x32_1 = 0xCD9E8D57u;
+    constexpr std::uint32_t W32_0 = 0x9E3779B9u; // golden ratio
+    constexpr std::uint32_t W32_1 = 0xBB67AE85u; // sqrt(3) - 1
+    constexpr int ROUNDS = 10;
+
+    constexpr std::uint32_t mulhi(std::uint32_t a, std::uint32_t b) {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(a) * b) >> 32);
+    }
+
+    // Philox2x32-10, one 32x32 multiply per round (cheap enough for SIMD lanes)
+    constexpr std::array<std::uint32_t, 2> philox2x32(std::uint32_t c0, std::uint32_t c1, std::uint32_t key) {
+        for (int r = 0; r < ROUNDS; r++) {
+            const std::uint32_t hi = mulhi(M2x32, c0);
+            const std::uint32_t lo = M2x32 * c0;
+            c0 = hi ^ key ^ c1;
+            c1 = lo;
+            key += W32_0;
+        }
+        return {c0, c1};
+    }
+
+    // Philox4x32-10, four 32 bit outputs per call
+    constexpr std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> c, std::array<std::uint32_t, 2> key) {
+        for (int r = 0; r < ROUNDS; r++) {
+            const std::uint32_t hi0 = mulhi(M4x32_0, c[0]);
+            const std::uint32_t lo0 = M4x32_0 * c[0];
+            const std::uint32_t hi1 = mulhi(M4x32_1, c[2]);
+            const std::uint32_t lo1 = M4x32_1 * c[2];
+            c = {hi1 ^ c[1] ^ key[0], lo1, hi0 ^ c[3] ^ key[1], lo0};
+            key[0] += W32_0;
+            key[1] += W32_1;
+        }
+        return c;
+    }
+
+    // folds a 64 bit seed into a 32 bit key
+    constexpr std::uint32_t foldSeed(std::uint64_t seed) {
+        return static_cast<std::uint32_t>(seed) ^ static_cast<std::uint32_t>(seed >> 32) * W32_1;
+    }
+
+    // uniform dice face in [1, faces] from 32 random bits (multiply-shift,
+    // bias below 2^-29 for six faces)
+    constexpr int diceFromBits(std::uint32_t bits, std::uint32_t faces = 6) {
+        return static_cast<int>(mulhi(bits, faces)) + 1;
+    }
+}
+
+class PhiloxEngine {
+    /* UniformRandomBitGenerator over Philox4x32-10 for use with the
+     standard distributions. The stream is identified by (key, streamId)
+     and walked by a 64 bit block counter, so stream n of a master seed
+     can be reproduced on its own, on any thread, in any order */
+    std::array<std::uint32_t, 2> key;
+    std::uint64_t streamId;
+    std::uint64_t block;
+    std::array<std::uint32_t, 4> buffer;
+    int used;
+
+    void refill() {
+        buffer = philox::philox4x32({static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32),
+            static_cast<std::uint32_t>(streamId), static_cast<std::uint32_t>(streamId >> 32)}, key);
+        block++;
+        used = 0;
+    }
+
+    public:
+    using result_type = std::uint32_t;
+
+    PhiloxEngine(std::uint64_t seed, std::uint64_t stream)
+        : key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+        streamId(stream), block(0), buffer{}, used(4) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (used == 4)
+            refill();
+        return buffer[used++];
+    }
+
+    // jumps to an arbitrary position of the stream (in 32 bit outputs)
+    void seek(std::uint64_t position) {
+        block = position / 4;
+        refill();
+        used = static_cast<int>(position % 4);
+    }
+};
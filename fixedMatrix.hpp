@@ -0,0 +1,242 @@
+#pragma once
+#include <stdexcept>
+#include "matrixView.hpp"
+
+// extent of a matrix whose size is only known at runtime
+constexpr int Dynamic = -1;
+
+template <class T, int Rows = Dynamic, int Cols = Dynamic>
+class Matrix {
+    /* fixed-extent matrix, Matrix<T> (both extents Dynamic) is the heap
+     backed specialization in matrix.hpp. The elements live inline, so
+     a Matrix<double, 99, 99> is a plain 78 KB value with no allocation,
+     no size checks (shapes are checked by the type system) and loops
+     with compile-time trip counts the compiler can unroll and
+     vectorize. Every operation is constexpr, so results on fixed
+     sizes can be computed during compilation.
+     Large instances belong in static storage or on the heap rather
+     than on small thread stacks */
+    static_assert(Rows > 0 && Cols > 0, "Fixed extents must be positive, use Matrix<T> for runtime sizes.");
+
+    alignas(64) T values[Rows * Cols];
+
+    static constexpr T absolute(T value) {
+        return value < T(0) ? -value : value;
+    }
+
+    public:
+    // Constructors
+    constexpr Matrix() : values{} {}
+
+    constexpr explicit Matrix(T defaultValue) : values{} {
+        for (int i = 0; i < Rows * Cols; i++)
+            values[i] = defaultValue;
+    }
+
+    // basic operations
+    constexpr T* operator[](int row) { return values + row * Cols; }
+    constexpr const T* operator[](int row) const { return values + row * Cols; }
+    constexpr T& operator()(int row, int col) { return values[row * Cols + col]; }
+    constexpr const T& operator()(int row, int col) const { return values[row * Cols + col]; }
+
+    // getters
+    static constexpr int getRows() { return Rows; }
+    static constexpr int getCols() { return Cols; }
+    static constexpr int getStride() { return Cols; }
+    static constexpr bool isEmpty() { return false; }
+    static constexpr bool isSquare() { return Rows == Cols; }
+    constexpr T* getData() { return values; }
+    constexpr const T* getData() const { return values; }
+
+    MatrixView<T> view() { return MatrixView<T>(values, Rows, Cols, Cols); }
+    ConstMatrixView<T> view() const { return ConstMatrixView<T>(values, Rows, Cols, Cols); }
+
+    // arithmetic
+    constexpr Matrix& operator += (const Matrix& other) {
+        for (int i = 0; i < Rows * Cols; i++)
+            values[i] += other.values[i];
+        return *this;
+    }
+
+    constexpr Matrix& operator -= (const Matrix& other) {
+        for (int i = 0; i < Rows * Cols; i++)
+            values[i] -= other.values[i];
+        return *this;
+    }
+
+    constexpr Matrix operator + (const Matrix& other) const {
+        Matrix result(*this);
+        result += other;
+        return result;
+    }
+
+    constexpr Matrix operator - (const Matrix& other) const {
+        Matrix result(*this);
+        result -= other;
+        return result;
+    }
+
+    constexpr Matrix operator * (T scalar) const {
+        Matrix result(*this);
+        for (int i = 0; i < Rows * Cols; i++)
+            result.values[i] *= scalar;
+        return result;
+    }
+
+    // i-k-j order, the inner loop runs over contiguous rows of both
+    template <int K>
+    constexpr Matrix<T, Rows, K> operator * (const Matrix<T, Cols, K>& other) const {
+        Matrix<T, Rows, K> result;
+        for (int i = 0; i < Rows; i++) {
+            for (int p = 0; p < Cols; p++) {
+                const T aip = (*this)(i, p);
+                if (aip == T(0))
+                    continue;
+                for (int j = 0; j < K; j++)
+                    result(i, j) += aip * other(p, j);
+            }
+        }
+        return result;
+    }
+
+    constexpr Matrix<T, Cols, Rows> transpose() const {
+        Matrix<T, Cols, Rows> transposed;
+        for (int i = 0; i < Rows; i++)
+            for (int j = 0; j < Cols; j++)
+                transposed(j, i) = (*this)(i, j);
+        return transposed;
+    }
+
+    // top-left NR x NC corner
+    template <int NR, int NC>
+    constexpr Matrix<T, NR, NC> leadingBlock() const {
+        static_assert(NR <= Rows && NC <= Cols, "Block exceeds the matrix.");
+        Matrix<T, NR, NC> block;
+        for (int i = 0; i < NR; i++)
+            for (int j = 0; j < NC; j++)
+                block(i, j) = (*this)(i, j);
+        return block;
+    }
+
+    // matrix inversion
+    // solves A X = B by gaussian elimination with partial pivoting
+    template <int K>
+    constexpr Matrix<T, Rows, K> solve(const Matrix<T, Rows, K>& rhs) const {
+        static_assert(Rows == Cols, "solve needs a square matrix.");
+        Matrix A(*this);
+        Matrix<T, Rows, K> B(rhs);
+        for (int k = 0; k < Rows; k++) {
+            int pivotRow = k;
+            for (int i = k + 1; i < Rows; i++) {
+                if (absolute(A(i, k)) > absolute(A(pivotRow, k)))
+                    pivotRow = i;
+            }
+            if (absolute(A(pivotRow, k)) < T(1e-14))
+                throw std::runtime_error("Matrix is singular and cannot be factorized.");
+            if (pivotRow != k) {
+                for (int j = k; j < Cols; j++) {
+                    const T tmp = A(k, j);
+                    A(k, j) = A(pivotRow, j);
+                    A(pivotRow, j) = tmp;
+                }
+                for (int j = 0; j < K; j++) {
+                    const T tmp = B(k, j);
+                    B(k, j) = B(pivotRow, j);
+                    B(pivotRow, j) = tmp;
+                }
+            }
+
+            const T pivotVal = A(k, k);
+            for (int i = k + 1; i < Rows; i++) {
+                if (A(i, k) == T(0))
+                    continue;
+                const T factor = A(i, k) / pivotVal;
+                for (int j = k + 1; j < Cols; j++)
+                    A(i, j) -= factor * A(k, j);
+                for (int j = 0; j < K; j++)
+                    B(i, j) -= factor * B(k, j);
+                A(i, k) = T(0);
+            }
+        }
+
+        // back substitution
+        for (int i = Rows - 1; i >= 0; i--) {
+            for (int j = i + 1; j < Cols; j++) {
+                const T uij = A(i, j);
+                if (uij == T(0))
+                    continue;
+                for (int c = 0; c < K; c++)
+                    B(i, c) -= uij * B(j, c);
+            }
+            for (int c = 0; c < K; c++)
+                B(i, c) /= A(i, i);
+        }
+        return B;
+    }
+
+    constexpr Matrix inverse() const {
+        return solve(identity());
+    }
+
+    constexpr T determinant() const {
+        static_assert(Rows == Cols, "Determinant is only defined for square matrices.");
+        Matrix A(*this);
+        T det = T(1);
+        for (int k = 0; k < Rows; k++) {
+            int pivotRow = k;
+            for (int i = k + 1; i < Rows; i++) {
+                if (absolute(A(i, k)) > absolute(A(pivotRow, k)))
+                    pivotRow = i;
+            }
+            if (A(pivotRow, k) == T(0))
+                return T(0);
+            if (pivotRow != k) {
+                for (int j = k; j < Cols; j++) {
+                    const T tmp = A(k, j);
+                    A(k, j) = A(pivotRow, j);
+                    A(pivotRow, j) = tmp;
+                }
+                det = -det;
+            }
+            det *= A(k, k);
+            for (int i = k + 1; i < Rows; i++) {
+                const T factor = A(i, k) / A(k, k);
+                for (int j = k + 1; j < Cols; j++)
+                    A(i, j) -= factor * A(k, j);
+            }
+        }
+        return det;
+    }
+
+    // utility functions
+    static constexpr Matrix identity() {
+        static_assert(Rows == Cols, "Identity is only defined for square matrices.");
+        Matrix I;
+        for (int i = 0; i < Rows; i++)
+            I(i, i) = T(1);
+        return I;
+    }
+
+    constexpr bool operator == (const Matrix& other) const {
+        for (int i = 0; i < Rows * Cols; i++) {
+            if (values[i] != other.values[i])
+                return false;
+        }
+        return true;
+    }
+
+    // conversions to / from the runtime sized matrix
+    Matrix<T> toDynamic() const {
+        return Matrix<T>(view());
+    }
+
+    static Matrix fromDynamic(const Matrix<T>& other) {
+        if (other.getRows() != Rows || other.getCols() != Cols)
+            throw std::invalid_argument("Matrix dimensions must match the fixed extents.");
+        Matrix result;
+        for (int i = 0; i < Rows; i++)
+            for (int j = 0; j < Cols; j++)
+                result(i, j) = other[i][j];
+        return result;
+    }
+};
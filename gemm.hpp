@@ -0,0 +1,175 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "simdKernels.hpp"
+
+namespace gemm {
+    /* blocked general matrix multiply C += A * B
+     A is m x k, B is k x n, C is m x n. A and B are addressed through a
+     row stride and a column stride (element (i, j) of A is at
+     A[i * rsA + j * csA]) so transposed or sliced views are read in place
+     while packing; C is row-major with leading dimension ldc
+
+     loop structure (Goto/BLIS style):
+       jc: NC columns of B and C        -> panel of B sized for L3
+       pc: KC depth slice               -> packed B panel (KC x NC) for L2
+       ic: MC rows of A and C           -> packed A block (MC x KC) for L2
+       jr, ir: MR x NR register tile    -> micro-kernel, L1 resident */
+
+    // register tile, shared with the SIMD micro-kernels
+    constexpr int MR = simd::GEMM_MR;
+    constexpr int NR = simd::GEMM_NR;
+
+    // cache blocks, KC x NR slice of B (16 KB for doubles) stays in L1,
+    // MC x KC block of A (192 KB) stays in L2
+    constexpr int MC = 96;
+    constexpr int KC = 256;
+    constexpr int NC = 2048;
+
+    // below this many multiply-adds packing costs more than it saves
+    constexpr long long BLOCKED_THRESHOLD = 48LL * 48LL * 48LL;
+
+    // packs an mc x kc block of A into row panels of MR rows,
+    // each panel stored column by column (MR contiguous values per k)
+    // rows past mc are zero padded so the micro-kernel never branches
+    template <class T>
+    void packA(int mc, int kc, const T *A, long rsA, long csA, T *packed) {
+        for (int i = 0; i < mc; i += MR) {
+            const int rowsLeft = std::min(MR, mc - i);
+            for (int p = 0; p < kc; p++) {
+                for (int r = 0; r < rowsLeft; r++)
+                    packed[r] = A[(i + r) * rsA + p * csA];
+                for (int r = rowsLeft; r < MR; r++)
+                    packed[r] = T(0);
+                packed += MR;
+            }
+        }
+    }
+
+    // packs a kc x nc block of B into column panels of NR columns,
+    // each panel stored row by row (NR contiguous values per k)
+    template <class T>
+    void packB(int kc, int nc, const T *B, long rsB, long csB, T *packed) {
+        for (int j = 0; j < nc; j += NR) {
+            const int colsLeft = std::min(NR, nc - j);
+            for (int p = 0; p < kc; p++) {
+                const T *bRow = B + p * rsB + j * csB;
+                for (int c = 0; c < colsLeft; c++)
+                    packed[c] = bRow[c * csB];
+                for (int c = colsLeft; c < NR; c++)
+                    packed[c] = T(0);
+                packed += NR;
+            }
+        }
+    }
+
+    // MR x NR register tile: accumulates kc rank-1 updates from packed
+    // panels and adds the tile into C (only the mr x nr valid part)
+    template <class T>
+    void microKernel(int kc, const T *a, const T *b, T *C, int ldc, int mr, int nr) {
+        T acc[MR][NR] = {};
+        for (int p = 0; p < kc; p++) {
+            for (int r = 0; r < MR; r++) {
+                const T ar = a[r];
+                for (int c = 0; c < NR; c++)
+                    acc[r][c] += ar * b[c];
+            }
+            a += MR;
+            b += NR;
+        }
+
+        for (int r = 0; r < mr; r++) {
+            T *cRow = C + r * static_cast<long>(ldc);
+            for (int c = 0; c < nr; c++)
+                cRow[c] += acc[r][c];
+        }
+    }
+
+    // plain i-k-j loop, used for small shapes and as a reference
+    template <class T>
+    void naive(int m, int n, int k, const T *A, long rsA, long csA,
+        const T *B, long rsB, long csB, T *C, int ldc) {
+        for (int i = 0; i < m; i++) {
+            T *cRow = C + i * static_cast<long>(ldc);
+            const T *aRow = A + i * rsA;
+            for (int p = 0; p < k; p++) {
+                const T aip = aRow[p * csA];
+                const T *bRow = B + p * rsB;
+                if (csB == 1) {
+                    for (int j = 0; j < n; j++)
+                        cRow[j] += aip * bRow[j];
+                } else {
+                    for (int j = 0; j < n; j++)
+                        cRow[j] += aip * bRow[j * csB];
+                }
+            }
+        }
+    }
+
+    template <class T>
+    void naive(int m, int n, int k, const T *A, int lda, const T *B, int ldb, T *C, int ldc) {
+        naive(m, n, k, A, lda, 1, B, ldb, 1, C, ldc);
+    }
+
+    template <class T>
+    void blocked(int m, int n, int k, const T *A, long rsA, long csA,
+        const T *B, long rsB, long csB, T *C, int ldc) {
+        // packing buffers are reused across calls on the same thread
+        static thread_local std::vector<T> packedA;
+        static thread_local std::vector<T> packedB;
+        packedA.resize(static_cast<size_t>(MC + MR) * KC);
+        packedB.resize(static_cast<size_t>(NC + NR) * KC);
+
+        // doubles go through the runtime-dispatched SIMD micro-kernel
+        auto kernel = microKernel<T>;
+        if constexpr (std::is_same_v<T, double>)
+            kernel = simd::active().microKernel;
+
+        for (int jc = 0; jc < n; jc += NC) {
+            const int nc = std::min(NC, n - jc);
+
+            for (int pc = 0; pc < k; pc += KC) {
+                const int kc = std::min(KC, k - pc);
+                packB(kc, nc, B + pc * rsB + jc * csB, rsB, csB, packedB.data());
+
+                for (int ic = 0; ic < m; ic += MC) {
+                    const int mc = std::min(MC, m - ic);
+                    packA(mc, kc, A + ic * rsA + pc * csA, rsA, csA, packedA.data());
+
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        const int nr = std::min(NR, nc - jr);
+                        const T *bPanel = packedB.data() + static_cast<long>(jr) * kc;
+
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            const int mr = std::min(MR, mc - ir);
+                            const T *aPanel = packedA.data() + static_cast<long>(ir) * kc;
+                            T *cTile = C + (ic + ir) * static_cast<long>(ldc) + jc + jr;
+                            kernel(kc, aPanel, bPanel, cTile, ldc, mr, nr);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // C += A * B, picks the blocked engine once the problem is big enough
+    template <class T>
+    void multiply(int m, int n, int k, const T *A, long rsA, long csA,
+        const T *B, long rsB, long csB, T *C, int ldc) {
+        if (m == 0 || n == 0 || k == 0)
+            return;
+
+        const long long work = static_cast<long long>(m) * n * k;
+        if (work < BLOCKED_THRESHOLD || m < MR || n < NR)
+            naive(m, n, k, A, rsA, csA, B, rsB, csB, C, ldc);
+        else
+            blocked(m, n, k, A, rsA, csA, B, rsB, csB, C, ldc);
+    }
+
+    // row-major operands with leading dimensions lda, ldb
+    template <class T>
+    void multiply(int m, int n, int k, const T *A, int lda, const T *B, int ldb, T *C, int ldc) {
+        multiply(m, n, k, A, lda, 1, B, ldb, 1, C, ldc);
+    }
+}
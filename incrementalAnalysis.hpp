@@ -0,0 +1,165 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "matrix.hpp"
+#include "jumpTable.hpp"
+#include "moveRules.hpp"
+#include "transitionMatrix.hpp"
+#include "simdKernels.hpp"
+
+class IncrementalAnalysis {
+    /* keeps N = (I - Q)^-1 and t = N 1 up to date while snakes and
+     ladders are added, moved or removed.
+     Changing the destination of block b from o to w only touches the
+     rows i = b-6 .. b-1 that reach b with one dice face, and every one
+     of them changes the same way: 1/6 moves from column o to column w.
+     So (I - Q)' = (I - Q) + u v^T with u the indicator of those rows and
+     v = (e_o - e_w) / 6 (columns of the absorbing block dropped), and
+     Sherman-Morrison gives
+        N' = N - (N u)(v^T N) / (1 + v^T N u)
+        t' = t - (N u)(v^T t) / (1 + v^T N u)
+     where N u is a sum of at most six columns and v^T N is the
+     difference of two rows, i.e. O(S^2) per edit instead of the O(S^3)
+     of a new factorization. Every update adds rounding error, so N and
+     t are rebuilt from scratch every refactorInterval edits or as soon
+     as the residual of (I - Q) t = 1 exceeds the tolerance */
+    JumpTable jumps;
+    int transientStates;
+    Matrix<double> N;
+    Matrix<double> t; // transientStates x 1
+    int refactorInterval;
+    double driftTolerance;
+    int updates;
+
+    // column j of the rank-one update, 0 for the absorbing block
+    double entry(const Matrix<double>& column, int j) const {
+        return j < transientStates ? column[j][0] : 0.0;
+    }
+
+    // destination of a token rolling from block onto block + dice
+    int destinationOf(int block, int dice) const {
+        return rules::moveDestination(block, dice, jumps.size(), jumps);
+    }
+
+    // Sherman-Morrison step for block b changing destination from o to w
+    void rankOneUpdate(int b, int o, int w) {
+        const int n = transientStates;
+        const int first = std::max(0, b - 6);
+
+        // N u: sum of the columns of the rows that reach b
+        Matrix<double> Nu = expr::lazy(N.block(0, first, n, b - first)) * expr::ones<double>(b - first, 1);
+
+        const double denominator = 1.0 + (entry(Nu, o) - entry(Nu, w)) / 6.0;
+        if (std::abs(denominator) < 1e-12)
+            throw std::runtime_error("Edit makes the winning block unreachable.");
+
+        // v^T N = (N[o] - N[w]) / 6, zero rows for the absorbing block
+        std::vector<double> vN(n, 0.0);
+        if (o < n)
+            simd::active().axpy(n, 1.0 / 6.0, N[o], vN.data());
+        if (w < n)
+            simd::active().axpy(n, -1.0 / 6.0, N[w], vN.data());
+
+        const double vt = (entry(t, o) - entry(t, w)) / 6.0;
+        for (int r = 0; r < n; r++) {
+            const double factor = Nu[r][0] / denominator;
+            if (factor == 0.0)
+                continue;
+            simd::active().axpy(n, -factor, vN.data(), N[r]);
+            t[r][0] -= factor * vt;
+        }
+    }
+
+    // turns a new destination of block start into a rank-one update
+    void changeDestination(int start, int end) {
+        if (start < 0 || start >= jumps.size() || end < 0 || end >= jumps.size())
+            throw std::out_of_range("Jump start and end must lie on the board.");
+
+        const int old = jumps[start];
+        // jumps on the start and winning block are never taken
+        if (old != end && start > 0 && start < transientStates)
+            rankOneUpdate(start, old, end);
+
+        if (end == start)
+            jumps.clearJump(start);
+        else
+            jumps.setJump(start, end);
+
+        updates++;
+        if (updates >= refactorInterval || residual() > driftTolerance)
+            refactorize();
+    }
+
+    public:
+    explicit IncrementalAnalysis(const JumpTable& table, int refactorEvery = 64, double tolerance = 1e-9)
+        : jumps(table), transientStates(table.size() - 1),
+        refactorInterval(refactorEvery), driftTolerance(tolerance), updates(0) {
+        if (table.size() < 2)
+            throw std::invalid_argument("A board needs at least two blocks.");
+        refactorize();
+    }
+
+    // adds a snake / ladder at start or moves the one already there
+    void setJump(int start, int end) {
+        changeDestination(start, end);
+    }
+
+    void clearJump(int start) {
+        changeDestination(start, start);
+    }
+
+    // moves the jump that starts at from so it starts at to instead
+    void moveJump(int from, int to) {
+        if (from < 0 || from >= jumps.size() || to < 0 || to >= jumps.size())
+            throw std::out_of_range("Jump start and end must lie on the board.");
+        if (!jumps.hasJump(from) || jumps[from] == from)
+            throw std::invalid_argument("No jump starts at the block to move from.");
+        if (to == from)
+            throw std::invalid_argument("Jump must move to a different block.");
+        const int end = jumps[from];
+        clearJump(from);
+        setJump(to, end);
+    }
+
+    // rebuilds N and t from the current board
+    void refactorize() {
+        TransitionMatrix pMatrix(jumps);
+        pMatrix.calculateProbabilities();
+        const LUFactorization<double>& lu = pMatrix.getFundamentalLU();
+        N = lu.inverse();
+        // t = N 1, the row sums of N
+        t = expr::lazy(N) * expr::ones<double>(transientStates, 1);
+        updates = 0;
+    }
+
+    // max |((I - Q) t - 1)_i| relative to max t, O(S)
+    double residual() const {
+        double worst = 0.0, largest = 0.0;
+        for (int i = 0; i < transientStates; i++) {
+            double r = t[i][0] - 1.0;
+            for (int dice = 1; dice <= 6; dice++)
+                r -= entry(t, destinationOf(i, dice)) / 6.0;
+            worst = std::max(worst, std::abs(r));
+            largest = std::max(largest, std::abs(t[i][0]));
+        }
+        return largest > 0.0 ? worst / largest : worst;
+    }
+
+    const Matrix<double>& getFundamentalMatrix() const {
+        return N;
+    }
+
+    const Matrix<double>& getExpectedMoves() const {
+        return t;
+    }
+
+    const JumpTable& getJumpTable() const {
+        return jumps;
+    }
+
+    int updatesSinceRefactorization() const {
+        return updates;
+    }
+};
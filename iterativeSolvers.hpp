@@ -0,0 +1,354 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include "sparseMatrix.hpp"
+
+/* iterative solvers for A x = b on the sparse (CSR) representation,
+ typically A = I - Q from TransitionMatrix::getSparseIMinusQ(), with
+ b = ones for expected moves or b = R for absorption probabilities.
+ Memory stays O(nnz) (plus the Krylov basis for GMRES) and every
+ iteration costs O(nnz), so million-state boards are practical */
+
+struct IterativeOptions {
+    double tolerance = 1e-10;   // on the relative residual ||b - Ax|| / ||b||
+    int maxIterations = 10000;
+    double omega = 1.0;         // SOR relaxation, 1.0 = Gauss-Seidel
+    bool descendingOrder = true; // sweep from the last block down to block 0
+    int restart = 30;           // GMRES Krylov dimension before restarting
+};
+
+struct IterativeResult {
+    std::vector<double> x;
+    std::vector<double> residualHistory; // relative residual per iteration
+    int iterations = 0;
+    bool converged = false;
+};
+
+class ILU0 {
+    /* incomplete LU with zero fill: L and U keep exactly the sparsity of
+     A (L unit lower, U upper incl. diagonal, both stored in one CSR copy).
+     Used as a preconditioner, apply(r) returns (LU)^-1 r */
+    std::vector<int> rowStart, colIndex, diagPos;
+    std::vector<double> values;
+    int n;
+
+    public:
+    explicit ILU0(const SparseMatrix<double>& A)
+        : rowStart(A.getRowStart()), colIndex(A.getColIndex()), diagPos(A.getRows(), -1),
+        values(A.getValues()), n(A.getRows()) {
+
+        for (int i = 0; i < n; i++) {
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++) {
+                if (colIndex[k] == i)
+                    diagPos[i] = k;
+            }
+            if (diagPos[i] == -1)
+                throw std::runtime_error("ILU(0) needs a stored diagonal entry in every row.");
+        }
+
+        // IKJ variant, position[j] maps column j of the current row to its slot
+        std::vector<int> position(n, -1);
+        for (int i = 0; i < n; i++) {
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+                position[colIndex[k]] = k;
+
+            for (int k = rowStart[i]; k < rowStart[i + 1] && colIndex[k] < i; k++) {
+                const int pivotRow = colIndex[k];
+                const double factor = values[k] / values[diagPos[pivotRow]];
+                values[k] = factor;
+                for (int p = diagPos[pivotRow] + 1; p < rowStart[pivotRow + 1]; p++) {
+                    const int slot = position[colIndex[p]];
+                    if (slot != -1)
+                        values[slot] -= factor * values[p];
+                }
+            }
+
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+                position[colIndex[k]] = -1;
+
+            if (values[diagPos[i]] == 0.0)
+                throw std::runtime_error("Zero pivot in ILU(0).");
+        }
+    }
+
+    // z = (LU)^-1 r
+    void apply(const double *r, double *z) const {
+        for (int i = 0; i < n; i++) {
+            double sum = r[i];
+            for (int k = rowStart[i]; k < diagPos[i]; k++)
+                sum -= values[k] * z[colIndex[k]];
+            z[i] = sum;
+        }
+        for (int i = n - 1; i >= 0; i--) {
+            double sum = z[i];
+            for (int k = diagPos[i] + 1; k < rowStart[i + 1]; k++)
+                sum -= values[k] * z[colIndex[k]];
+            z[i] = sum / values[diagPos[i]];
+        }
+    }
+};
+
+namespace iterative {
+    inline double dot(const std::vector<double>& x, const std::vector<double>& y) {
+        double sum = 0.0;
+        for (size_t i = 0; i < x.size(); i++)
+            sum += x[i] * y[i];
+        return sum;
+    }
+
+    inline double norm(const std::vector<double>& x) {
+        return std::sqrt(dot(x, x));
+    }
+
+    // ||b - A x|| / ||b||
+    inline double relativeResidual(const SparseMatrix<double>& A, const std::vector<double>& x,
+        const std::vector<double>& b, double bNorm) {
+        std::vector<double> Ax = A * x;
+        double sum = 0.0;
+        for (size_t i = 0; i < b.size(); i++)
+            sum += (b[i] - Ax[i]) * (b[i] - Ax[i]);
+        return std::sqrt(sum) / bNorm;
+    }
+
+    inline void checkSystem(const SparseMatrix<double>& A, const std::vector<double>& b) {
+        if (A.getRows() != A.getCols() || static_cast<int>(b.size()) != A.getRows())
+            throw std::invalid_argument("Iterative solvers need a square matrix and a matching right hand side.");
+    }
+
+    inline double diagonalOf(const SparseMatrix<double>::Row& r, int i) {
+        for (int k = 0; k < r.size(); k++) {
+            if (r.col(k) == i)
+                return r.value(k);
+        }
+        throw std::runtime_error("Jacobi / Gauss-Seidel need a non-zero diagonal.");
+    }
+
+    inline IterativeResult jacobi(const SparseMatrix<double>& A, const std::vector<double>& b,
+        const IterativeOptions& options = IterativeOptions()) {
+        checkSystem(A, b);
+        const int n = A.getRows();
+        const double bNorm = std::max(norm(b), 1e-300);
+        IterativeResult result;
+        result.x.assign(n, 0.0);
+        std::vector<double> next(n);
+
+        std::vector<double> diagonal(n);
+        for (int i = 0; i < n; i++)
+            diagonal[i] = diagonalOf(A.row(i), i);
+
+        for (int it = 0; it < options.maxIterations; it++) {
+            for (int i = 0; i < n; i++) {
+                SparseMatrix<double>::Row r = A.row(i);
+                double sum = b[i];
+                for (int k = 0; k < r.size(); k++) {
+                    if (r.col(k) != i)
+                        sum -= r.value(k) * result.x[r.col(k)];
+                }
+                next[i] = sum / diagonal[i];
+            }
+            result.x.swap(next);
+            result.iterations = it + 1;
+
+            const double residual = relativeResidual(A, result.x, b, bNorm);
+            result.residualHistory.push_back(residual);
+            if (residual < options.tolerance) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+    // SOR / Gauss-Seidel (omega = 1), updates in place in block order.
+    // Most entries of I - Q point forward, so sweeping from the last block
+    // down lets every update use already refreshed successors
+    inline IterativeResult gaussSeidel(const SparseMatrix<double>& A, const std::vector<double>& b,
+        const IterativeOptions& options = IterativeOptions()) {
+        checkSystem(A, b);
+        const int n = A.getRows();
+        const double bNorm = std::max(norm(b), 1e-300);
+        IterativeResult result;
+        result.x.assign(n, 0.0);
+
+        std::vector<double> diagonal(n);
+        for (int i = 0; i < n; i++)
+            diagonal[i] = diagonalOf(A.row(i), i);
+
+        for (int it = 0; it < options.maxIterations; it++) {
+            for (int step = 0; step < n; step++) {
+                const int i = options.descendingOrder ? n - 1 - step : step;
+                SparseMatrix<double>::Row r = A.row(i);
+                double sum = b[i];
+                for (int k = 0; k < r.size(); k++) {
+                    if (r.col(k) != i)
+                        sum -= r.value(k) * result.x[r.col(k)];
+                }
+                result.x[i] += options.omega * (sum / diagonal[i] - result.x[i]);
+            }
+            result.iterations = it + 1;
+
+            const double residual = relativeResidual(A, result.x, b, bNorm);
+            result.residualHistory.push_back(residual);
+            if (residual < options.tolerance) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+    // restarted GMRES(m) with right ILU(0) preconditioning: solves
+    // A M^-1 u = b and returns x = M^-1 u, so the residual tracked by
+    // the Arnoldi process is the true residual of A x = b
+    inline IterativeResult gmres(const SparseMatrix<double>& A, const std::vector<double>& b,
+        const IterativeOptions& options = IterativeOptions()) {
+        checkSystem(A, b);
+        const int n = A.getRows();
+        const int m = std::max(1, options.restart);
+        const double bNorm = std::max(norm(b), 1e-300);
+        ILU0 preconditioner(A);
+
+        IterativeResult result;
+        result.x.assign(n, 0.0);
+        std::vector<std::vector<double>> V(m + 1, std::vector<double>(n));
+        std::vector<std::vector<double>> H(m + 1, std::vector<double>(m, 0.0));
+        std::vector<double> cs(m), sn(m), g(m + 1), z(n), w(n);
+
+        while (result.iterations < options.maxIterations) {
+            // r = b - A x
+            std::vector<double> Ax = A * result.x;
+            for (int i = 0; i < n; i++)
+                V[0][i] = b[i] - Ax[i];
+            double beta = norm(V[0]);
+            if (beta / bNorm < options.tolerance) {
+                result.converged = true;
+                break;
+            }
+            for (double& v : V[0])
+                v /= beta;
+            std::fill(g.begin(), g.end(), 0.0);
+            g[0] = beta;
+
+            int j = 0;
+            for (; j < m && result.iterations < options.maxIterations; j++) {
+                preconditioner.apply(V[j].data(), z.data());
+                A.multiply(z.data(), w.data());
+
+                // modified Gram-Schmidt
+                for (int i = 0; i <= j; i++) {
+                    H[i][j] = dot(w, V[i]);
+                    for (int k = 0; k < n; k++)
+                        w[k] -= H[i][j] * V[i][k];
+                }
+                H[j + 1][j] = norm(w);
+                if (H[j + 1][j] > 0.0) {
+                    for (int k = 0; k < n; k++)
+                        V[j + 1][k] = w[k] / H[j + 1][j];
+                }
+
+                // Givens rotations keep H upper triangular
+                for (int i = 0; i < j; i++) {
+                    const double t = cs[i] * H[i][j] + sn[i] * H[i + 1][j];
+                    H[i + 1][j] = -sn[i] * H[i][j] + cs[i] * H[i + 1][j];
+                    H[i][j] = t;
+                }
+                const double r = std::hypot(H[j][j], H[j + 1][j]);
+                cs[j] = H[j][j] / r;
+                sn[j] = H[j + 1][j] / r;
+                H[j][j] = r;
+                H[j + 1][j] = 0.0;
+                g[j + 1] = -sn[j] * g[j];
+                g[j] = cs[j] * g[j];
+
+                result.iterations++;
+                const double residual = std::abs(g[j + 1]) / bNorm;
+                result.residualHistory.push_back(residual);
+                if (residual < options.tolerance) {
+                    j++;
+                    break;
+                }
+            }
+
+            // y = H^-1 g, then x += M^-1 (V y)
+            std::vector<double> y(j);
+            for (int i = j - 1; i >= 0; i--) {
+                double sum = g[i];
+                for (int k = i + 1; k < j; k++)
+                    sum -= H[i][k] * y[k];
+                y[i] = sum / H[i][i];
+            }
+            std::fill(w.begin(), w.end(), 0.0);
+            for (int i = 0; i < j; i++)
+                for (int k = 0; k < n; k++)
+                    w[k] += y[i] * V[i][k];
+            preconditioner.apply(w.data(), z.data());
+            for (int k = 0; k < n; k++)
+                result.x[k] += z[k];
+
+            if (!result.residualHistory.empty() && result.residualHistory.back() < options.tolerance) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+    // BiCGSTAB with right ILU(0) preconditioning
+    inline IterativeResult bicgstab(const SparseMatrix<double>& A, const std::vector<double>& b,
+        const IterativeOptions& options = IterativeOptions()) {
+        checkSystem(A, b);
+        const int n = A.getRows();
+        const double bNorm = std::max(norm(b), 1e-300);
+        ILU0 preconditioner(A);
+
+        IterativeResult result;
+        result.x.assign(n, 0.0);
+        std::vector<double> r(b), rHat(b), p(n, 0.0), v(n, 0.0), s(n), t(n), pHat(n), sHat(n);
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+        for (int it = 0; it < options.maxIterations; it++) {
+            const double rhoNext = dot(rHat, r);
+            if (rhoNext == 0.0)
+                break; // breakdown
+            const double beta = (rhoNext / rho) * (alpha / omega);
+            rho = rhoNext;
+            for (int i = 0; i < n; i++)
+                p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+            preconditioner.apply(p.data(), pHat.data());
+            A.multiply(pHat.data(), v.data());
+            alpha = rho / dot(rHat, v);
+            for (int i = 0; i < n; i++)
+                s[i] = r[i] - alpha * v[i];
+
+            result.iterations = it + 1;
+            if (norm(s) / bNorm < options.tolerance) {
+                for (int i = 0; i < n; i++)
+                    result.x[i] += alpha * pHat[i];
+                result.residualHistory.push_back(norm(s) / bNorm);
+                result.converged = true;
+                break;
+            }
+
+            preconditioner.apply(s.data(), sHat.data());
+            A.multiply(sHat.data(), t.data());
+            omega = dot(t, s) / dot(t, t);
+            for (int i = 0; i < n; i++) {
+                result.x[i] += alpha * pHat[i] + omega * sHat[i];
+                r[i] = s[i] - omega * t[i];
+            }
+
+            const double residual = norm(r) / bNorm;
+            result.residualHistory.push_back(residual);
+            if (residual < options.tolerance) {
+                result.converged = true;
+                break;
+            }
+            if (omega == 0.0)
+                break;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,263 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "sparseMatrix.hpp"
+#include "transitionMatrix.hpp"
+#include "simdKernels.hpp"
+
+// how players on the same board affect each other
+enum class Interaction {
+    None,   // independent races
+    Bump    // landing on an occupied block sends its owner back to block 0
+};
+
+class KroneckerOperator {
+    /* joint chain of p players without the S^p x S^p matrix.
+     A joint state holds one block per seat, flattened as
+        index = s_0 + s_1 S + s_2 S^2 + ...
+     and the move of seat i alone is the Kronecker product
+        M_i = I (x) .. (x) P (x) .. (x) I      (P in factor i)
+     so x M_i is a mode-i product: for every block a of seat i and every
+     entry P[a][b], a contiguous run of S^i states moves from a to b
+     (one axpy), O(S^p nnz(P) / S) in total. Interaction is a sparse
+     correction on top: with bumping, the mass of every state where seat
+     i moves onto the block of seat j (other than the start and winning
+     blocks) is moved on to the state with seat j back on block 0.
+     Only P and the two state vectors are ever stored */
+    SparseMatrix<double> P;
+    int blocks;
+    int players;
+    Interaction rule;
+    long long stateCount;
+    std::vector<long long> strides; // strides[i] = S^i
+    // predecessors[b] = (a, P[a][b]) for a != b
+    std::vector<std::vector<std::pair<int, double>>> predecessors;
+
+    // index offsets of every joint state with seats i and j on block 0
+    std::vector<long long> restOffsets(int i, int j) const {
+        std::vector<long long> offsets(1, 0);
+        for (int k = 0; k < players; k++) {
+            if (k == i || k == j)
+                continue;
+            std::vector<long long> expanded;
+            expanded.reserve(offsets.size() * blocks);
+            for (int block = 0; block < blocks; block++) {
+                for (long long offset : offsets)
+                    expanded.push_back(offset + block * strides[k]);
+            }
+            offsets.swap(expanded);
+        }
+        return offsets;
+    }
+
+    public:
+    KroneckerOperator(const TransitionMatrix& chain, int playerCount, Interaction interaction = Interaction::Bump,
+        long long maxStates = 1LL << 27)
+        : P(chain.getSparseTransitionMatrix()), blocks(P.getRows()), players(playerCount),
+        rule(interaction), stateCount(1) {
+        if (blocks == 0)
+            throw std::invalid_argument("Transition matrix is empty, calculate the probabilities first.");
+        if (players < 1)
+            throw std::invalid_argument("A joint chain needs at least one player.");
+        for (int i = 0; i < players; i++) {
+            strides.push_back(stateCount);
+            if (stateCount > maxStates / blocks)
+                throw std::invalid_argument("Joint state space exceeds the state limit.");
+            stateCount *= blocks;
+        }
+
+        predecessors.resize(blocks);
+        for (int a = 0; a < blocks; a++) {
+            const SparseMatrix<double>::Row row = P.row(a);
+            for (int k = 0; k < row.size(); k++) {
+                if (row.col(k) != a)
+                    predecessors[row.col(k)].emplace_back(a, row.value(k));
+            }
+        }
+    }
+
+    long long size() const {
+        return stateCount;
+    }
+
+    int getPlayers() const {
+        return players;
+    }
+
+    int getBlocks() const {
+        return blocks;
+    }
+
+    Interaction getInteraction() const {
+        return rule;
+    }
+
+    int position(long long index, int seat) const {
+        return static_cast<int>(index / strides[seat] % blocks);
+    }
+
+    long long index(const std::vector<int>& positions) const {
+        if (static_cast<int>(positions.size()) != players)
+            throw std::invalid_argument("Need one position per player.");
+        long long result = 0;
+        for (int i = 0; i < players; i++) {
+            if (positions[i] < 0 || positions[i] >= blocks)
+                throw std::out_of_range("Position must lie on the board.");
+            result += positions[i] * strides[i];
+        }
+        return result;
+    }
+
+    std::vector<int> positions(long long index) const {
+        std::vector<int> result(players);
+        for (int i = 0; i < players; i++)
+            result[i] = position(index, i);
+        return result;
+    }
+
+    // y = x M_seat, the distribution after seat moves once
+    void applyMove(int seat, const std::vector<double>& x, std::vector<double>& y) const {
+        if (seat < 0 || seat >= players)
+            throw std::out_of_range("Seat out of range.");
+        if (static_cast<long long>(x.size()) != stateCount)
+            throw std::invalid_argument("State vector has the wrong size.");
+        y.assign(stateCount, 0.0);
+
+        // Kronecker factor: mode product with P
+        const long long stride = strides[seat];
+        const long long span = stride * blocks;
+        for (long long outer = 0; outer < stateCount; outer += span) {
+            for (int a = 0; a < blocks; a++) {
+                const double *from = x.data() + outer + a * stride;
+                const SparseMatrix<double>::Row row = P.row(a);
+                for (int k = 0; k < row.size(); k++) {
+                    double *to = y.data() + outer + row.col(k) * stride;
+                    if (stride == 1)
+                        to[0] += row.value(k) * from[0];
+                    else
+                        simd::active().axpy(static_cast<int>(stride), row.value(k), from, to);
+                }
+            }
+        }
+
+        if (rule == Interaction::None || players == 1)
+            return;
+
+        // interaction correction: seat moves from a onto b, the block of
+        // other; the remaining seats range over the same offsets
+        for (int other = 0; other < players; other++) {
+            if (other == seat)
+                continue;
+            const std::vector<long long> rest = restOffsets(seat, other);
+            for (int b = 1; b < blocks - 1; b++) {
+                const long long occupied = b * strides[other];
+                for (const std::pair<int, double>& entry : predecessors[b]) {
+                    const long long source = occupied + entry.first * stride;
+                    const long long landed = occupied + b * stride;
+                    for (long long offset : rest) {
+                        const double mass = x[source + offset] * entry.second;
+                        y[landed + offset] -= mass;
+                        y[landed - occupied + offset] += mass;
+                    }
+                }
+            }
+        }
+    }
+
+    // removes the mass of every state with seat on the winning block and returns it
+    double absorb(int seat, std::vector<double>& y) const {
+        const long long stride = strides[seat];
+        const long long span = stride * blocks;
+        const long long offset = static_cast<long long>(blocks - 1) * stride;
+        double absorbed = 0.0;
+        for (long long outer = 0; outer < stateCount; outer += span) {
+            double *won = y.data() + outer + offset;
+            for (long long k = 0; k < stride; k++) {
+                absorbed += won[k];
+                won[k] = 0.0;
+            }
+        }
+        return absorbed;
+    }
+};
+
+class InteractingRaceAnalysis {
+    /* race of p players on one board under an interaction rule, on the
+     joint chain of KroneckerOperator. Seats move in order 0 .. p-1; the
+     mass a seat moves onto the winning block is taken out as its win in
+     that round, so the remaining vector only holds running games and
+     the sweep stops once their mass drops below the tail tolerance.
+     Without interaction the results match RaceAnalysis */
+    KroneckerOperator op;
+    std::vector<double> winProbabilities;
+    std::vector<double> roundsPMF; // P(game ends in round k)
+    double expectedRounds;
+    double expectedMoves;
+    double unresolved;
+
+    public:
+    InteractingRaceAnalysis(const TransitionMatrix& chain, int players, Interaction rule = Interaction::Bump,
+        int startBlock = 0, double tailTolerance = 1e-10, int maxRounds = 100000)
+        : op(chain, players, rule), winProbabilities(players, 0.0), roundsPMF(1, 0.0),
+        expectedRounds(0.0), expectedMoves(0.0), unresolved(1.0) {
+        if (startBlock < 0 || startBlock >= op.getBlocks() - 1)
+            throw std::out_of_range("Start block must be a transient state.");
+
+        std::vector<double> x(op.size(), 0.0), y;
+        x[op.index(std::vector<int>(players, startBlock))] = 1.0;
+        for (int round = 1; round <= maxRounds && unresolved > tailTolerance; round++) {
+            // P(game lasts past round - 1)
+            expectedRounds += unresolved;
+            double ended = 0.0;
+            for (int seat = 0; seat < players; seat++) {
+                op.applyMove(seat, x, y);
+                const double won = op.absorb(seat, y);
+                winProbabilities[seat] += won;
+                ended += won;
+                expectedMoves += won * (static_cast<double>(round - 1) * players + seat + 1);
+                x.swap(y);
+            }
+            roundsPMF.push_back(ended);
+            unresolved = 0.0;
+            for (double v : x)
+                unresolved += v;
+        }
+    }
+
+    int getPlayers() const {
+        return op.getPlayers();
+    }
+
+    double winProbability(int seat) const {
+        return winProbabilities.at(seat);
+    }
+
+    const std::vector<double>& getWinProbabilities() const {
+        return winProbabilities;
+    }
+
+    const std::vector<double>& getRoundsPMF() const {
+        return roundsPMF;
+    }
+
+    double getExpectedRounds() const {
+        return expectedRounds;
+    }
+
+    // total moves made by all players together
+    double getExpectedMoves() const {
+        return expectedMoves;
+    }
+
+    // mass of the games still running after the last round
+    double unresolvedProbability() const {
+        return unresolved;
+    }
+
+    int horizon() const {
+        return static_cast<int>(roundsPMF.size()) - 1;
+    }
+};
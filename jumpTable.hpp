@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include "boardEntity.hpp"
+#include "snake.hpp"
+#include "ladder.hpp"
+
+enum class EntityKind : std::int8_t { None, Snake, Ladder };
+
+class JumpTable {
+    /* flat board representation for the hot paths:
+     destination[i] is where a token that lands on block i ends up
+     (i itself for an empty block), so resolving a move is a single
+     load with no virtual call or 2D index math. kind is a side array
+     with what sits on each block, only read for reporting */
+    std::vector<std::int32_t> destination;
+    std::vector<EntityKind> kind;
+
+    public:
+    JumpTable() {}
+
+    explicit JumpTable(int totalBlocks)
+        : destination(totalBlocks), kind(totalBlocks, EntityKind::None) {
+        for (int i = 0; i < totalBlocks; i++)
+            destination[i] = i;
+    }
+
+    // flattens a Board grid of BoardEntity pointers (row-major blocks)
+    static JumpTable fromGrid(const std::vector<std::vector<BoardEntity*>>& grid, int boardLength) {
+        const int height = static_cast<int>(grid.size());
+        JumpTable table(height * boardLength);
+        for (int i = 0; i < height; i++) {
+            for (int j = 0; j < boardLength; j++) {
+                BoardEntity *entity = grid[i][j];
+                if (entity == nullptr)
+                    continue;
+                const EntityKind k = dynamic_cast<Snake*>(entity) ? EntityKind::Snake : EntityKind::Ladder;
+                table.setJump(i * boardLength + j, entity->getTargetBlock(), k);
+            }
+        }
+        return table;
+    }
+
+    void setJump(int start, int end, EntityKind k) {
+        if (start < 0 || start >= size() || end < 0 || end >= size())
+            throw std::out_of_range("Jump start and end must lie on the board.");
+        destination[start] = end;
+        kind[start] = k;
+    }
+
+    // adds a snake or ladder, the kind follows from the direction
+    void setJump(int start, int end) {
+        setJump(start, end, end < start ? EntityKind::Snake : EntityKind::Ladder);
+    }
+
+    void clearJump(int start) {
+        destination[start] = start;
+        kind[start] = EntityKind::None;
+    }
+
+    int operator[](int block) const {
+        return destination[block];
+    }
+
+    EntityKind kindAt(int block) const {
+        return kind[block];
+    }
+
+    bool hasJump(int block) const {
+        return kind[block] != EntityKind::None;
+    }
+
+    int size() const {
+        return static_cast<int>(destination.size());
+    }
+
+    // raw destination array, e.g. for gathers in the batch simulators
+    const std::int32_t* data() const {
+        return destination.data();
+    }
+
+    bool operator==(const JumpTable& other) const {
+        return destination == other.destination && kind == other.kind;
+    }
+};
@@ -0,0 +1,356 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include "matrix.hpp"
+#include "simdKernels.hpp"
+
+template <class T>
+class LUFactorization {
+    /* PA = LU with partial (row) pivoting, stored in place:
+     the strict lower triangle of lu holds L (unit diagonal implied),
+     the upper triangle holds U, pivots[i] is the original row that
+     ended up in row i. A singular matrix factorized with
+     allowingSingular also gets column exchanges, PAQ = LU with
+     columns[i] the original column i. Factorizing once lets every right hand side be
+     solved in O(n^2) instead of inverting in O(n^3) */
+    Matrix<T> lu;
+    std::vector<int> pivots;
+    std::vector<int> columns; // column permutation, only singular matrices get one
+    int swapCount;
+    int n;
+    // < 0: a missing pivot throws, otherwise pivots up to
+    // singularTolerance * max |A_ij| count as zero columns
+    T singularTolerance;
+    int deficientColumns;
+
+    // y += a * x over a contiguous range
+    static void axpy(int count, T a, const T *x, T *y) {
+        if constexpr (std::is_same_v<T, double>) {
+            simd::active().axpy(count, a, x, y);
+        } else {
+            for (int j = 0; j < count; j++)
+                y[j] += a * x[j];
+        }
+    }
+
+    void decompose() {
+        if (!lu.isSquare())
+            throw std::invalid_argument("LU factorization is only defined for square matrices.");
+
+        n = lu.getRows();
+        swapCount = 0;
+        deficientColumns = 0;
+        pivots.resize(n);
+        columns.resize(n);
+        for (int i = 0; i < n; i++)
+            pivots[i] = columns[i] = i;
+
+        T threshold = T(0);
+        if (singularTolerance >= T(0)) {
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < n; j++)
+                    threshold = std::max(threshold, T(std::abs(lu[i][j])));
+            threshold *= singularTolerance;
+        }
+
+        for (int k = 0; k < n; k++) {
+            int pivotRow = lu.findPivot(k, k);
+            if (singularTolerance >= T(0)) {
+                // no pivot in column k: swap in a later column that has
+                // one, so the zero pivots all end up at the bottom right
+                int column = k;
+                while (column < n && (pivotRow == -1 || std::abs(lu[pivotRow][column]) <= threshold)) {
+                    if (++column < n)
+                        pivotRow = lu.findPivot(column, k);
+                }
+                if (column == n) {
+                    // the remaining block is zero up to the tolerance
+                    for (int i = k; i < n; i++)
+                        for (int j = k; j < n; j++)
+                            lu[i][j] = T(0);
+                    deficientColumns = n - k;
+                    break;
+                }
+                if (column != k) {
+                    for (int i = 0; i < n; i++)
+                        std::swap(lu[i][k], lu[i][column]);
+                    std::swap(columns[k], columns[column]);
+                    swapCount++;
+                }
+            } else if (pivotRow == -1 || lu.isNearZero(lu[pivotRow][k], T(1e-14))) {
+                throw std::runtime_error("Matrix is singular and cannot be factorized.");
+            }
+
+            if (pivotRow != k) {
+                lu.swapRows(k, pivotRow);
+                std::swap(pivots[k], pivots[pivotRow]);
+                swapCount++;
+            }
+
+            // eliminate below the pivot, the multiplier is kept in place of the zero
+            const T *pivotTail = lu[k] + k + 1;
+            const T pivotVal = lu[k][k];
+            for (int i = k + 1; i < n; i++) {
+                T *row = lu[i];
+                if (row[k] == T(0))
+                    continue;
+                const T factor = row[k] / pivotVal;
+                row[k] = factor;
+                axpy(n - k - 1, -factor, pivotTail, row + k + 1);
+            }
+        }
+    }
+
+    void checkRows(int rows) const {
+        if (rows != n)
+            throw std::invalid_argument("Right hand side must have as many rows as the factorized matrix.");
+        checkRegular();
+    }
+
+    void checkRegular() const {
+        if (deficientColumns > 0)
+            throw std::runtime_error("Matrix is singular and cannot be solved.");
+    }
+
+    // X holds PB on entry and the solution of A X = B on return
+    void substitute(Matrix<T>& X) const {
+        const int k = X.getCols();
+
+        // forward substitution with unit lower triangle: L Y = PB
+        for (int i = 0; i < n; i++) {
+            const T *lRow = lu[i];
+            for (int j = 0; j < i; j++) {
+                if (lRow[j] != T(0))
+                    axpy(k, -lRow[j], X[j], X[i]);
+            }
+        }
+
+        // back substitution: U X = Y
+        for (int i = n - 1; i >= 0; i--) {
+            const T *uRow = lu[i];
+            for (int j = i + 1; j < n; j++) {
+                if (uRow[j] != T(0))
+                    axpy(k, -uRow[j], X[j], X[i]);
+            }
+            const T inv = T(1) / uRow[i];
+            T *xRow = X[i];
+            for (int c = 0; c < k; c++)
+                xRow[c] *= inv;
+        }
+    }
+
+    public:
+    LUFactorization() : swapCount(0), n(0), singularTolerance(-1), deficientColumns(0) {}
+
+    explicit LUFactorization(const Matrix<T>& A) : lu(A), singularTolerance(-1) {
+        decompose();
+    }
+
+    // takes ownership of A's buffer and factorizes it in place
+    explicit LUFactorization(Matrix<T>&& A) : lu(std::move(A)), singularTolerance(-1) {
+        decompose();
+    }
+
+    // factorizes a possibly singular A: a column whose best pivot is
+    // at most tolerance * max |A_ij| gets an exact zero pivot and is
+    // counted by rankDeficiency(); solves then throw, but the
+    // determinant and adjugate are still defined
+    static LUFactorization<T> allowingSingular(const Matrix<T>& A, T tolerance = T(1e-10)) {
+        LUFactorization<T> f;
+        f.lu = A;
+        f.singularTolerance = std::max(tolerance, T(0));
+        f.decompose();
+        return f;
+    }
+
+    // reuses this object (and its pivot vector) for another matrix
+    void factorize(const Matrix<T>& A) {
+        lu = A;
+        decompose();
+    }
+
+    void factorize(Matrix<T>&& A) {
+        lu = std::move(A);
+        decompose();
+    }
+
+    int size() const {
+        return n;
+    }
+
+    // number of columns without a pivot, 0 for a regular matrix
+    int rankDeficiency() const {
+        return deficientColumns;
+    }
+
+    // solves A X = B for every column of B (n x k) at once; B may be a
+    // view into a larger matrix, X is the only allocation
+    Matrix<T> solveMany(const ConstMatrixView<T>& B) const {
+        checkRows(B.getRows());
+        const int k = B.getCols();
+
+        // apply the row permutation
+        Matrix<T> X(n, k);
+        for (int i = 0; i < n; i++) {
+            T *dst = X[i];
+            for (int c = 0; c < k; c++)
+                dst[c] = B(pivots[i], c);
+        }
+        substitute(X);
+        return X;
+    }
+
+    Matrix<T> solveMany(const Matrix<T>& B) const {
+        return solveMany(B.view());
+    }
+
+    // solves A x = b for a single column vector b (n x 1)
+    Matrix<T> solve(const ConstMatrixView<T>& b) const {
+        if (b.getCols() != 1)
+            throw std::invalid_argument("solve expects a column vector, use solveMany for several.");
+        return solveMany(b);
+    }
+
+    Matrix<T> solve(const Matrix<T>& b) const {
+        return solve(b.view());
+    }
+
+    // solves A^T x = b, i.e. x^T A = b^T (row i of A^-1 when b = e_i)
+    Matrix<T> solveTranspose(const Matrix<T>& b) const {
+        checkRows(b.getRows());
+        if (b.getCols() != 1)
+            throw std::invalid_argument("solveTranspose expects a column vector.");
+
+        // A^T = U^T L^T P, so solve U^T z = b, then L^T w = z, then x = P^T w
+        std::vector<T> z(n);
+        for (int i = 0; i < n; i++)
+            z[i] = b[i][0];
+
+        for (int i = 0; i < n; i++) {
+            z[i] /= lu[i][i];
+            const T zi = z[i];
+            // column i of U^T is row i of U
+            axpy(n - i - 1, -zi, lu[i] + i + 1, z.data() + i + 1);
+        }
+
+        for (int i = n - 1; i >= 0; i--) {
+            const T *lRow = lu[i];
+            const T zi = z[i];
+            // column i of L^T is row i of L (strict part)
+            for (int j = 0; j < i; j++)
+                z[j] -= lRow[j] * zi;
+        }
+
+        Matrix<T> x(n, 1);
+        for (int i = 0; i < n; i++)
+            x[pivots[i]][0] = z[i];
+        return x;
+    }
+
+    // A^-1 via n solves, only for callers that really need every entry;
+    // the permuted identity is written straight into the result
+    Matrix<T> inverse() const {
+        checkRegular();
+        Matrix<T> X(n, n, T(0));
+        for (int i = 0; i < n; i++)
+            X[i][pivots[i]] = T(1);
+        substitute(X);
+        return X;
+    }
+
+    // adj(A), defined for singular A as well:
+    //  - regular: det(A) A^-1
+    //  - rank n - 1: the one zero pivot is U[n-1][n-1]; with u the right
+    //    null vector of U (u_{n-1} = 1), x = Q u, and y the left null
+    //    vector of A from L^T P y = e_{n-1}, the limit of det(A) A^-1 as
+    //    that pivot goes to 0 is d x y^T, d = sign * prod_{i < n-1} U[i][i]
+    //  - lower rank: every (n-1) x (n-1) minor vanishes, adj(A) = 0
+    // O(n^3) for the factorization, O(n^2) on top of it
+    Matrix<T> adjugate() const {
+        if (deficientColumns == 0) {
+            Matrix<T> adj = inverse();
+            const T det = determinant();
+            for (int i = 0; i < n; i++) {
+                T *row = adj[i];
+                for (int j = 0; j < n; j++)
+                    row[j] *= det;
+            }
+            return adj;
+        }
+
+        Matrix<T> adj(n, n, T(0));
+        if (deficientColumns > 1)
+            return adj;
+
+        const int k = n - 1;
+        T d = (swapCount % 2 == 0) ? T(1) : T(-1);
+        for (int i = 0; i < k; i++)
+            d *= lu[i][i];
+
+        // U u = 0 by back substitution, then undo the column exchanges
+        std::vector<T> u(n, T(0));
+        u[k] = T(1);
+        for (int i = k - 1; i >= 0; i--) {
+            const T *uRow = lu[i];
+            T sum = T(0);
+            for (int j = i + 1; j <= k; j++)
+                sum += uRow[j] * u[j];
+            u[i] = -sum / uRow[i];
+        }
+        std::vector<T> x(n);
+        for (int i = 0; i < n; i++)
+            x[columns[i]] = u[i];
+
+        // L^T w = e_k, unit upper triangular, then y = P^T w
+        std::vector<T> w(n, T(0));
+        w[k] = T(1);
+        for (int i = n - 1; i >= 0; i--) {
+            const T *lRow = lu[i];
+            const T wi = w[i];
+            for (int j = 0; j < i; j++)
+                w[j] -= lRow[j] * wi;
+        }
+        std::vector<T> y(n);
+        for (int i = 0; i < n; i++)
+            y[pivots[i]] = w[i];
+
+        for (int i = 0; i < n; i++) {
+            const T scale = d * x[i];
+            T *row = adj[i];
+            for (int j = 0; j < n; j++)
+                row[j] = scale * y[j];
+        }
+        return adj;
+    }
+
+    T determinant() const {
+        T det = (swapCount % 2 == 0) ? T(1) : T(-1);
+        for (int i = 0; i < n; i++)
+            det *= lu[i][i];
+        return det;
+    }
+
+    // log |det A|, sign returned through the out parameter (+1 / -1)
+    T logAbsDeterminant(int &sign) const {
+        sign = (swapCount % 2 == 0) ? 1 : -1;
+        T logDet = T(0);
+        for (int i = 0; i < n; i++) {
+            const T u = lu[i][i];
+            if (u < T(0))
+                sign = -sign;
+            logDet += std::log(std::abs(u));
+        }
+        return logDet;
+    }
+
+    const Matrix<T>& getFactors() const {
+        return lu;
+    }
+
+    const std::vector<int>& getPivots() const {
+        return pivots;
+    }
+};
@@ -6,6 +6,13 @@
 #include "boardEntity.hpp"
 #include "board.hpp"
 #include "transitionMatrix.hpp"
+#include "absorptionTime.hpp"
+#include "spectralTail.hpp"
+#include "matrixPowerCache.hpp"
+#include "raceAnalysis.hpp"
+#include "jointChain.hpp"
+#include "monteCarloSimulator.hpp"
+#include "canonicalBoards.hpp"
 #include "matplotlibcpp.h"
 
 namespace plt = matplotlibcpp;
@@ -26,21 +33,18 @@ int main() {
     // declaring constants for initialising a random Snake & Ladder board
     const int snakesCount = 8 + rand() % 4, ladderCount = 8 + rand() % 4;
     const int boardLength = 10, boardHeight = 10;
-    int totalStates = boardHeight*boardLength;
 
     Board *board = new Board(snakesCount, ladderCount, boardLength, boardHeight);
     board->displayBoard();
 
-    TransitionMatrix pMatrix(board->getBoard(), boardLength*boardHeight, boardLength);
+    TransitionMatrix pMatrix(board->getJumpTable());
     pMatrix.calculateProbabilities();
     // matrix.exportToCSV("dataset.csv");
 
-    Matrix<double> fundamentalMatrix = pMatrix.getFundamentalMatrix();
-
     // ANALYSIS: expected total moves to win from each block
-    int numStates = fundamentalMatrix.getRows();
-    Matrix<double> ones(numStates, 1, 1.0);
-    Matrix<double> expectedMoves = fundamentalMatrix * ones;
+    // N x 1 is solved from the LU of (I - Q) instead of inverting it
+    Matrix<double> expectedMoves = pMatrix.getExpectedMoves();
+    int numStates = expectedMoves.getRows();
 
     // plotting
     vector<double> blocks;
@@ -61,42 +65,48 @@ int main() {
     // double avgGameLength = expectedMoves[0][0];
     // cout << "Expected moves to win from start: " << avgGameLength << endl;
 
-    // ANALYSIS: probability of being on each square after K turns
-    Matrix<double> P = pMatrix.getTransitionMatrix();
-
-    Matrix<double> initialDistribution (totalStates, 1, 0.0);
-    initialDistribution[0][0] = 1.0; // always starts from square 1 on the board
+    // CROSS-CHECK: simulated games on all cores against the analytical mean
+    MonteCarloSimulator simulator(board->getJumpTable());
+    SimulationResult simulated = simulator.run(1000000, static_cast<uint64_t>(time(nullptr)));
+    cout << "Expected moves to win from start: " << expectedMoves[0][0]
+         << " (simulated: " << simulated.meanLength << ", variance " << simulated.varianceLength << ")" << endl;
+
+    // CANONICAL BOARD: solved at compile time, nothing is computed here
+    cout << "Classic board: expected moves " << boards::classic.expectedMoves[0]
+         << ", won within 50 turns " << boards::classic.winProbability[50] << endl;
+
+    // ANALYSIS: distribution of the game length from square 1, one sweep
+    // gives the win probability after every turn, the spread and quantiles
+    AbsorptionTimeDistribution gameLength(pMatrix, 0);
+    cout << "Game length: variance " << gameLength.variance() << ", median " << gameLength.median()
+         << ", 90% of games within " << gameLength.quantile(0.9) << " turns" << endl;
+
+    // the long tail decays at the dominant eigenvalue of Q
+    SpectralTailModel tail(pMatrix, 0);
+    cout << "Tail: P(T > k) ~ " << tail.dominantEigenvalue() << "^k, one game in a million lasts over "
+         << tail.turnsUntilSurvivalBelow(1e-6) << " turns" << endl;
+
+    // distribution after a given turn by repeated squaring of P
+    MatrixPowerCache powers(pMatrix);
+    cout << "Win probability after 500 turns: " << powers.winProbability(0, 500) << endl;
+
+    // four players racing from square 1, seat 0 moves first
+    RaceAnalysis race(pMatrix, 4);
+    cout << "4-player race: expected rounds " << race.getExpectedRounds() << ", seat wins";
+    for (double p : race.getWinProbabilities())
+        cout << " " << p;
+    cout << endl;
+
+    // two players who bump each other back to square 1, on the joint chain
+    InteractingRaceAnalysis bumping(pMatrix, 2, Interaction::Bump);
+    cout << "2-player race with bumping: expected rounds " << bumping.getExpectedRounds()
+         << ", seat wins " << bumping.winProbability(0) << " " << bumping.winProbability(1) << endl;
 
     vector<double> steps;
-    for (int i = 0; i < 100; i++) {
-        steps.push_back(static_cast<double>(i));
-    }
-
     vector<double> winningProbs;
-
-    for (int k: steps) {
-        // cout<<"\nAfter "<<k<<" turns"<<endl;
-
-        Matrix<double> currentDistribution = initialDistribution;
-        for (int turn = 0; turn < k; turn++)
-            currentDistribution = P.transpose() * currentDistribution;
-
-        double winProbability = currentDistribution[totalStates -1][0];
-        winningProbs.push_back(winProbability);
-        // cout<<"Probability of winning: "<<winProbability<<endl;
-        
-        // most likely position (excluding absorbing state)
-        int mostLikelyPos = 0;
-        double maxProb = currentDistribution[0][0];
-        
-        for (int i = 1; i < totalStates-1; i++) {
-            if (currentDistribution[i][0] > maxProb) {
-                maxProb = currentDistribution[i][0];
-                mostLikelyPos = i;
-            }
-        }
-
-        // cout<<"Most likely position: "<<mostLikelyPos + 1<<" (probability: "<<maxProb<<")"<<endl;
+    for (int k = 0; k < 100; k++) {
+        steps.push_back(static_cast<double>(k));
+        winningProbs.push_back(gameLength.cdf(k));
     }
 
     plt::figure();
@@ -107,4 +117,6 @@ int main() {
     plt::grid(true);
     plt::show();
 
+    delete board;
+
 }
\ No newline at end of file
@@ -3,11 +3,28 @@
 #include <vector>
 #include <math.h>
 #include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include "matrixStorage.hpp"
+#include "matrixView.hpp"
+#include "fixedMatrix.hpp"
+#include "matrixExpression.hpp"
+#include "gemm.hpp"
+#include "simdKernels.hpp"
+#include <type_traits>
+#include <limits>
+
+// determinant, adjugate and invertibility go through the LU, which is
+// included at the end of this file (it needs the complete Matrix)
+template <class T>
+class LUFactorization;
 
+// runtime sized matrix, the fixed-extent primary template is in fixedMatrix.hpp
 template <class T>
-class Matrix {
+class Matrix<T, Dynamic, Dynamic> {
     private:
-    std::vector<std::vector<T>> *data;
+    // contiguous, 64-byte aligned row-major storage
+    MatrixStorage<T> data;
     int rows, cols;
 
     public:
@@ -17,23 +34,46 @@ class Matrix {
     Matrix(int rows, int cols, T defaultValue);
     Matrix(const std::vector<std::vector<T>>& input);
     Matrix(const Matrix<T>& other); // copy constructor
+    Matrix(Matrix<T>&& other) noexcept; // move constructor
+    Matrix(const ConstMatrixView<T>& view); // copies the viewed elements
+    template <class E>
+    Matrix(const expr::Expression<E>& e); // evaluates a lazy expression
 
     // basic operations
     Matrix<T>& operator=(const Matrix<T>& other);
-    std::vector<T>& operator[](int row);
-    const std::vector<T>& operator[](int row) const;
+    Matrix<T>& operator=(Matrix<T>&& other) noexcept;
+    template <class E>
+    Matrix<T>& operator=(const expr::Expression<E>& e);
+    T* operator[](int row);
+    const T* operator[](int row) const;
     
     // getters
     int getRows() const;
     int getCols() const;
+    int getStride() const; // elements between the starts of consecutive rows
+    T* getData();
+    const T* getData() const;
     bool isEmpty() const;
     bool isSquare() const;
 
+    // views, valid until this matrix is resized or destroyed
+    MatrixView<T> view();
+    ConstMatrixView<T> view() const;
+    MatrixView<T> block(int row, int col, int numRows, int numCols);
+    ConstMatrixView<T> block(int row, int col, int numRows, int numCols) const;
+
     // arithmetic
     Matrix<T> operator + (const Matrix<T>& other) const;
+    Matrix<T> operator + (const ConstMatrixView<T>& other) const;
     Matrix<T> operator - (const Matrix<T>& other) const;
+    Matrix<T> operator - (const ConstMatrixView<T>& other) const;
     Matrix<T> operator * (const Matrix<T>& other) const;
+    Matrix<T> operator * (const ConstMatrixView<T>& other) const;
     Matrix<T> operator * (T scalar) const;
+    Matrix<T>& operator += (const ConstMatrixView<T>& other);
+    Matrix<T>& operator -= (const ConstMatrixView<T>& other);
+    Matrix<T>& operator += (const Matrix<T>& other);
+    Matrix<T>& operator -= (const Matrix<T>& other);
 
     // helpers
     Matrix<T> getMinor(int excludeRow, int excludeCol) const;
@@ -41,7 +81,8 @@ class Matrix {
     Matrix<T> adjugate() const;
 
     // matrix inversion
-    T determinant() const;
+    T determinant() const; // LU with partial pivoting, O(n^3)
+    T logDeterminant(int &sign) const; // log|det|, sign is -1, 0 or +1
     Matrix<T> transpose() const;
     bool isInvertible() const;
     Matrix<T> inverse() const; // guass jordan
@@ -60,50 +101,116 @@ class Matrix {
 
 // CONSTRUCTORS
 template <class T>
-Matrix<T>::Matrix() : data(new std::vector<std::vector<T>>()), 
-    rows(0), cols(0) {}
+Matrix<T>::Matrix() : data(), rows(0), cols(0) {}
 
 template <class T>
 Matrix<T>::Matrix(int rows, int cols):
-    data(new std::vector<std::vector<T>>(rows, std::vector<T>(cols))),
+    data(rows, cols, T()),
     rows(rows), cols(cols) {}
 
 template <class T>
 Matrix<T>::Matrix(int rows, int cols, T defaultValue):
-    data(new std::vector<std::vector<T>>(rows, std::vector<T>(cols, defaultValue))),
+    data(rows, cols, defaultValue),
     rows(rows), cols(cols) {}
 
 template <class T>
 Matrix<T>::Matrix(const std::vector<std::vector<T>> &input) :
-    data(new std::vector<std::vector<T>>(input)),
+    data(input.size(), input.empty() ? 0 : input[0].size()),
     rows(input.size()),
-    cols(input.empty() ? 0 : input[0].size()) {}
+    cols(input.empty() ? 0 : input[0].size()) {
+    for (int i = 0; i < rows; i++) {
+        if (static_cast<int>(input[i].size()) != cols)
+            throw std::invalid_argument("All rows must have the same number of columns.");
+        std::copy(input[i].begin(), input[i].end(), data.row(i));
+    }
+}
 
 // copy constructor
 template <class T>
 Matrix<T>::Matrix(const Matrix<T> &other):
-    data(new std::vector<std::vector<T>>(*other.data)),
+    data(other.data),
     rows(other.rows), cols(other.cols) {}
 
+// move constructor: steals the buffer, other is left empty
+template <class T>
+Matrix<T>::Matrix(Matrix<T> &&other) noexcept:
+    data(std::move(other.data)),
+    rows(other.rows), cols(other.cols) {
+    other.rows = 0;
+    other.cols = 0;
+}
+
+template <class T>
+Matrix<T>::Matrix(const ConstMatrixView<T> &view):
+    data(view.getRows(), view.getCols()),
+    rows(view.getRows()), cols(view.getCols()) {
+    for (int i = 0; i < rows; i++) {
+        T *dst = data.row(i);
+        if (view.hasContiguousRows()) {
+            const T *src = &view(i, 0);
+            std::copy(src, src + cols, dst);
+            continue;
+        }
+        for (int j = 0; j < cols; j++)
+            dst[j] = view(i, j);
+    }
+}
+
+// the result buffer is the only allocation, see matrixExpression.hpp
+template <class T>
+template <class E>
+Matrix<T>::Matrix(const expr::Expression<E> &e):
+    data(e.rows(), e.cols()),
+    rows(e.rows()), cols(e.cols()) {
+    expr::evaluate(view(), e.derived());
+}
+
 // OPERATORS
 template <class T>
 Matrix<T>& Matrix<T>::operator=(const Matrix<T>& other) {
     if (this != &other) {
         rows = other.rows;
         cols = other.cols;
-        *data = *other.data;
+        data = other.data;
+    }
+    return *this;
+}
+
+template <class T>
+Matrix<T>& Matrix<T>::operator=(Matrix<T>&& other) noexcept {
+    if (this != &other) {
+        rows = other.rows;
+        cols = other.cols;
+        data = std::move(other.data);
+        other.rows = 0;
+        other.cols = 0;
     }
     return *this;
 }
 
+// reuses the current buffer when the shape matches and the expression
+// does not read from it, otherwise evaluates into a fresh matrix
+template <class T>
+template <class E>
+Matrix<T>& Matrix<T>::operator=(const expr::Expression<E>& e) {
+    const E& x = e.derived();
+    const T *begin = getData();
+    const T *end = begin + static_cast<long>(rows) * getStride();
+    if (rows == x.rows() && cols == x.cols() && !x.aliases(begin, end)) {
+        expr::evaluate(view(), x);
+        return *this;
+    }
+    return *this = Matrix<T>(e);
+}
+
 template <class T>
-std::vector<T>& Matrix<T>::operator[](int row) {
-    return (*data)[row];
+T* Matrix<T>::operator[](int row) {
+    return data.row(row);
 }
 
 template <class T>
-const std::vector<T>& Matrix<T>::operator[](int row) const {
-    return (*data)[row];
+const T* Matrix<T>::operator[](int row) const {
+    return data.row(row);
 }
 
 // GETTERS
@@ -117,9 +224,24 @@ int Matrix<T>::Matrix::getCols() const {
     return cols;
 }
 
+template <class T>
+int Matrix<T>::getStride() const {
+    return data.getStride();
+}
+
+template <class T>
+T* Matrix<T>::getData() {
+    return data.data();
+}
+
+template <class T>
+const T* Matrix<T>::getData() const {
+    return data.data();
+}
+
 template <class T>
 bool Matrix<T>::Matrix::isEmpty() const {
-    return (*data).empty();
+    return rows == 0 || cols == 0;
 }
 
 template <class T>
@@ -127,57 +249,92 @@ bool Matrix<T>::isSquare() const {
     return rows == cols && rows > 0;
 }
 
+// VIEWS
+template <class T>
+MatrixView<T> Matrix<T>::view() {
+    return MatrixView<T>(getData(), rows, cols, getStride());
+}
+
+template <class T>
+ConstMatrixView<T> Matrix<T>::view() const {
+    return ConstMatrixView<T>(getData(), rows, cols, getStride());
+}
+
+template <class T>
+MatrixView<T> Matrix<T>::block(int row, int col, int numRows, int numCols) {
+    return view().block(row, col, numRows, numCols);
+}
+
+template <class T>
+ConstMatrixView<T> Matrix<T>::block(int row, int col, int numRows, int numCols) const {
+    return view().block(row, col, numRows, numCols);
+}
+
 // ARITHMETIC OPERATORS
 template <class T>
 Matrix<T> Matrix<T>::operator + (const Matrix& other) const {
-    if (rows != other.rows || cols != other.cols) {
+    return (*this) + other.view();
+}
+
+template <class T>
+Matrix<T> Matrix<T>::operator + (const ConstMatrixView<T>& other) const {
+    if (rows != other.getRows() || cols != other.getCols()) {
         throw std::invalid_argument("Matrix dimensions must match for addition.");
     }
 
     Matrix<T> modified(*this);
-
-    for (int i = 0; i<rows; i++) {
-        for (int j = 0; j<cols; j++) {
-            modified[i][j] += other[i][j];
-        }
-    }
-
+    modified += other;
     return modified;
 }
 
 template <class T>
 Matrix<T> Matrix<T>::operator - (const Matrix& other) const {
-    if (rows != other.rows || cols != other.cols) {
+    return (*this) - other.view();
+}
+
+template <class T>
+Matrix<T> Matrix<T>::operator - (const ConstMatrixView<T>& other) const {
+    if (rows != other.getRows() || cols != other.getCols()) {
         throw std::invalid_argument("Matrix dimensions must match for subtraction.");
     }
 
     Matrix<T> modified(*this);
-
-    for (int i = 0; i<rows; i++) {
-        for (int j = 0; j<cols; j++) {
-            modified[i][j] -= other[i][j];
-        }
-    }
-
+    modified -= other;
     return modified;
 }
 
 template <class T>
 Matrix<T> Matrix<T>::operator * (const Matrix& other) const {
-    if (cols != other.rows) {
+    return (*this) * other.view();
+}
+
+// the right operand may be any strided view (a block, a column, a
+// transpose); its strides are folded into the GEMM packing
+template <class T>
+Matrix<T> Matrix<T>::operator * (const ConstMatrixView<T>& other) const {
+    if (cols != other.getRows()) {
         throw std::invalid_argument("Columns of first matrix must be equal to Rows of the second matrix.");
     }
 
-    Matrix<T> modified(rows, other.cols);
-    for (int i = 0; i<rows; i++) {
-        for (int j = 0; j< other.cols; j++) {
-            T sum = T();
-            for (int k = 0; k < cols; k++) {
-                sum += (*this)[i][k] * other[k][j];
-            }
-            modified[i][j] = sum;
+    // tiled GEMM for large shapes, i-k-j loop for tiny ones (see gemm.hpp)
+    Matrix<T> modified(rows, other.getCols(), T(0));
+    if constexpr (std::is_same_v<T, double>) {
+        // matrix x column vector: SIMD GEMV
+        if (other.getCols() == 1) {
+            std::vector<double> x(cols);
+            for (int k = 0; k < cols; k++)
+                x[k] = other(k, 0);
+            std::vector<double> y(rows, 0.0);
+            simd::active().gemv(rows, cols, getData(), getStride(), x.data(), y.data());
+            for (int i = 0; i < rows; i++)
+                modified[i][0] = y[i];
+            return modified;
         }
     }
+    gemm::multiply(rows, other.getCols(), cols,
+        getData(), static_cast<long>(getStride()), 1L,
+        other.getData(), other.getRowStride(), other.getColStride(),
+        modified.getData(), modified.getStride());
 
     return modified;
 }
@@ -187,6 +344,10 @@ Matrix<T> Matrix<T>::operator * (T scalar) const {
     Matrix<T> modified(*this);
 
     for (int i = 0; i<rows; i++) {
+        if constexpr (std::is_same_v<T, double>) {
+            simd::active().scale(cols, scalar, modified[i]);
+            continue;
+        }
         for (int j = 0; j<cols; j++) {
             modified[i][j] *= scalar;
         }
@@ -195,6 +356,53 @@ Matrix<T> Matrix<T>::operator * (T scalar) const {
     return modified;
 }
 
+template <class T>
+Matrix<T>& Matrix<T>::operator += (const ConstMatrixView<T>& other) {
+    if (rows != other.getRows() || cols != other.getCols()) {
+        throw std::invalid_argument("Matrix dimensions must match for addition.");
+    }
+
+    for (int i = 0; i < rows; i++) {
+        if constexpr (std::is_same_v<T, double>) {
+            if (other.hasContiguousRows()) {
+                simd::active().axpy(cols, 1.0, &other(i, 0), (*this)[i]);
+                continue;
+            }
+        }
+        for (int j = 0; j < cols; j++)
+            (*this)[i][j] += other(i, j);
+    }
+    return *this;
+}
+
+template <class T>
+Matrix<T>& Matrix<T>::operator -= (const ConstMatrixView<T>& other) {
+    if (rows != other.getRows() || cols != other.getCols()) {
+        throw std::invalid_argument("Matrix dimensions must match for subtraction.");
+    }
+
+    for (int i = 0; i < rows; i++) {
+        if constexpr (std::is_same_v<T, double>) {
+            if (other.hasContiguousRows()) {
+                simd::active().axpy(cols, -1.0, &other(i, 0), (*this)[i]);
+                continue;
+            }
+        }
+        for (int j = 0; j < cols; j++)
+            (*this)[i][j] -= other(i, j);
+    }
+    return *this;
+}
+
+template <class T>
+Matrix<T>& Matrix<T>::operator += (const Matrix<T>& other) {
+    return (*this) += other.view();
+}
+
+template <class T>
+Matrix<T>& Matrix<T>::operator -= (const Matrix<T>& other) {
+    return (*this) -= other.view();
+}
 
 // HELPERS
 template <class T>
@@ -207,7 +415,7 @@ Matrix<T> Matrix<T>::getMinor(int excludeRow, int excludeCol) const {
         int mj = 0;
         for (int j = 0; j < cols; ++j) {
             if (j == excludeCol) continue;
-            minor[mi][mj] = (*data)[i][j];
+            minor[mi][mj] = (*this)[i][j];
             mj+=1;
         }
         mi+=1;
@@ -225,14 +433,11 @@ template <class T>
 Matrix<T> Matrix<T>::adjugate() const {
     if (!isSquare())
         throw std::invalid_argument("Adjugate is only defined for square matrices.");
-    
-    Matrix<T> adj(rows, cols);
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            adj[j][i] = cofactor(i, j); // transpose
-        }
-    }
-    return adj;
+
+    // one LU for every rank: det(A) A^-1 when A is invertible, the outer
+    // product of the null vectors for rank n - 1 and zero below that;
+    // pivots are judged relative to the magnitude of A, as in isInvertible
+    return LUFactorization<T>::allowingSingular(*this).adjugate();
 }
 
 // MATRIX INVERSION
@@ -242,25 +447,46 @@ T Matrix<T>::determinant() const {
         throw std::invalid_argument("Determinant is only defined for square matrices.");
 
     if (rows == 1)
-        return (*data)[0][0];
+        return (*this)[0][0];
     
     if (rows == 2)
-        return (*data)[0][0] * (*data)[1][1] - (*data)[0][1] * (*data)[1][0];
-    
-    T det = 0;
-    for (int j = 0; j < cols; ++j)
-        det += (*data)[0][j] * cofactor(0, j);
-    
-    return det;
+        return (*this)[0][0] * (*this)[1][1] - (*this)[0][1] * (*this)[1][0];
+
+    // det = sign of the permutations * product of the pivots, a column
+    // without any non-zero pivot gives an exact zero
+    return LUFactorization<T>::allowingSingular(*this, T(0)).determinant();
+}
+
+template <class T>
+T Matrix<T>::logDeterminant(int &sign) const {
+    if (!isSquare())
+        throw std::invalid_argument("Determinant is only defined for square matrices.");
+
+    // summing logs of the pivots avoids the over/underflow of their product
+    const LUFactorization<T> lu = LUFactorization<T>::allowingSingular(*this, T(0));
+    if (lu.rankDeficiency() > 0) {
+        sign = 0;
+        return -std::numeric_limits<T>::infinity();
+    }
+    return lu.logAbsDeterminant(sign);
 }
 
 template <class T>
 Matrix<T> Matrix<T>::transpose() const {
     Matrix<T> transposed(cols, rows);
 
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            transposed[j][i] = (*this)[i][j];
+    // tiled so that both the source rows and the destination rows of a
+    // tile stay resident in L1 while it is copied
+    const int tile = 32;
+    for (int ii = 0; ii < rows; ii += tile) {
+        const int iEnd = std::min(ii + tile, rows);
+        for (int jj = 0; jj < cols; jj += tile) {
+            const int jEnd = std::min(jj + tile, cols);
+            for (int i = ii; i < iEnd; ++i) {
+                const T *src = (*this)[i];
+                for (int j = jj; j < jEnd; ++j)
+                    transposed[j][i] = src[j];
+            }
         }
     }
     return transposed;
@@ -273,7 +499,9 @@ bool Matrix<T>::isInvertible() const {
     if (isEmpty())
         return false;
 
-    return !isNearZero(determinant());
+    // checks each pivot against the magnitude of the matrix instead of
+    // the determinant itself, which underflows for large boards
+    return LUFactorization<T>::allowingSingular(*this).rankDeficiency() == 0;
 }
 
 template <class T>
@@ -296,14 +524,14 @@ Matrix<T> Matrix<T>::inverse() const {
     // augmenting with identity matrix
     for (int i = 0; i < n; ++i) {
         for (int j = 0; j < n; ++j) {
-            (*augmented.data)[i][j + n] = identity[i][j];
+            augmented[i][j + n] = identity[i][j];
         }
     }
 
     // Gauss-Jordan elimination
     for (int i = 0; i < n; i++) {
         int pivotRow = augmented.findPivot(i, i);
-        if (pivotRow == -1 || isNearZero((*augmented.data)[pivotRow][i]))
+        if (pivotRow == -1 || isNearZero(augmented[pivotRow][i]))
             throw std::runtime_error("Matrix is singular and cannot be inverted.");
 
         // if pivot row not current row
@@ -311,13 +539,13 @@ Matrix<T> Matrix<T>::inverse() const {
             augmented.swapRows(i, pivotRow);
 
         // nomralising to make pivot val= 1.0
-        T pivotVal = (*augmented.data)[i][i];
+        T pivotVal = augmented[i][i];
         augmented.multiplyRow(i, 1.0 /pivotVal);
 
         // modifying other rows
         for (int k = 0; k <n; k++) {
             if (k == i) continue;
-            T factor = (*augmented.data)[k][i];
+            T factor = augmented[k][i];
             augmented.addMultipleOfRow(k, i, -factor);
         }
     }
@@ -326,7 +554,7 @@ Matrix<T> Matrix<T>::inverse() const {
     Matrix<T> inv(n, n);
     for (int i = 0; i < n; ++i)
         for (int j = 0; j < n; ++j)
-            inv[i][j] = (*augmented.data)[i][j + n];
+            inv[i][j] = augmented[i][j + n];
 
     return inv;
 }
@@ -346,7 +574,7 @@ void Matrix<T>::swapRows(int row1, int row2) {
     if (row1 < 0 || row2 < 0 || row1 >= rows || row2 >= rows)
         throw std::out_of_range("Row index out of range in swapRows.");
     
-    std::swap((*data)[row1], (*data)[row2]);
+    std::swap_ranges((*this)[row1], (*this)[row1] + cols, (*this)[row2]);
 }
 
 template <class T>
@@ -354,8 +582,13 @@ void Matrix<T>::multiplyRow(int row, T factor) {
     if (row < 0 || row >= rows)
         throw std::out_of_range("Row index out of range in multiplyRow.");
 
+    T *r = (*this)[row];
+    if constexpr (std::is_same_v<T, double>) {
+        simd::active().scale(cols, factor, r);
+        return;
+    }
     for (int j = 0; j < cols; j++)
-        (*data)[row][j] *= factor;
+        r[j] *= factor;
 }
 
 template <class T>
@@ -363,8 +596,14 @@ void Matrix<T>::addMultipleOfRow(int targetRow, int sourceRow, T factor) {
     if (targetRow < 0 || targetRow >= rows || sourceRow < 0 || sourceRow >= rows)
         throw std::out_of_range("Row index out of range in multiplyRow.");
 
+    T *target = (*this)[targetRow];
+    const T *source = (*this)[sourceRow];
+    if constexpr (std::is_same_v<T, double>) {
+        simd::active().axpy(cols, factor, source, target);
+        return;
+    }
     for (int j = 0; j < cols; j++)
-        (*data)[targetRow][j] += factor * (*this)[sourceRow][j];
+        target[j] += factor * source[j];
 }
 
 template <class T>
@@ -377,7 +616,7 @@ int Matrix<T>::findPivot(int col, int startRow) const {
     int pivotRow = -1;
     T maxVal = 0;
     for (int i = startRow; i < rows; ++i) {
-        T val = std::abs((*data)[i][col]);
+        T val = std::abs((*this)[i][col]);
         if (val > maxVal) {
             maxVal = val;
             pivotRow = i;
@@ -395,4 +634,6 @@ void Matrix<T>::print() const {
         
         std::cout << std::endl;
     }
-}
\ No newline at end of file
+}
+
+#include "luFactorization.hpp"
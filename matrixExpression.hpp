@@ -0,0 +1,332 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "matrixView.hpp"
+#include "gemm.hpp"
+#include "simdKernels.hpp"
+#include "fixedMatrix.hpp"
+
+namespace expr {
+    /* expression templates over Matrix / MatrixView.
+     An arithmetic expression built from lazy(...) operands, identity(n)
+     and ones(r, c) is a tree of small value types; nothing is computed
+     until it is assigned to a Matrix. Then
+       - element-wise trees (+, -, scalar *) are evaluated in one fused
+         pass, element (i, j) read straight from every leaf
+       - transposes swap the strides of the leaf view (or the indices of
+         a sub-expression) and never copy
+       - identity and ones are symbolic: I * X and X * I are X, X * ones
+         and ones * X are row / column sums, I - Q reads Q once
+       - a product of two views goes to the strided GEMM (or GEMV for a
+         column) writing directly into the destination
+     Only a product whose operand is itself a compound expression needs
+     a temporary, for that operand alone.
+     Leaves hold views, so the matrices they refer to must outlive the
+     expression (do not keep one in an auto variable past a statement
+     that modifies its operands) */
+
+    template <class E>
+    struct Expression {
+        const E& derived() const { return static_cast<const E&>(*this); }
+        int rows() const { return derived().rows(); }
+        int cols() const { return derived().cols(); }
+    };
+
+    // LEAVES
+    template <class T>
+    class Ref : public Expression<Ref<T>> {
+        ConstMatrixView<T> v;
+
+        public:
+        using value_type = T;
+        explicit Ref(const ConstMatrixView<T>& view) : v(view) {}
+
+        int rows() const { return v.getRows(); }
+        int cols() const { return v.getCols(); }
+        T operator()(int i, int j) const { return v(i, j); }
+        const ConstMatrixView<T>& view() const { return v; }
+
+        bool aliases(const T *begin, const T *end) const {
+            if (v.isEmpty())
+                return false;
+            const T *first = v.getData();
+            const T *last = &v(v.getRows() - 1, v.getCols() - 1);
+            return std::max(first, last) >= begin && std::min(first, last) < end;
+        }
+    };
+
+    template <class T>
+    class Identity : public Expression<Identity<T>> {
+        int n;
+
+        public:
+        using value_type = T;
+        explicit Identity(int size) : n(size) {}
+
+        int rows() const { return n; }
+        int cols() const { return n; }
+        T operator()(int i, int j) const { return i == j ? T(1) : T(0); }
+        bool aliases(const T*, const T*) const { return false; }
+    };
+
+    template <class T>
+    class Ones : public Expression<Ones<T>> {
+        int r, c;
+
+        public:
+        using value_type = T;
+        Ones(int rows, int cols) : r(rows), c(cols) {}
+
+        int rows() const { return r; }
+        int cols() const { return c; }
+        T operator()(int, int) const { return T(1); }
+        bool aliases(const T*, const T*) const { return false; }
+    };
+
+    // NODES
+    template <class L, class R, class Op>
+    class Binary : public Expression<Binary<L, R, Op>> {
+        L left;
+        R right;
+
+        public:
+        using value_type = typename L::value_type;
+        Binary(const L& l, const R& r) : left(l), right(r) {
+            if (l.rows() != r.rows() || l.cols() != r.cols())
+                throw std::invalid_argument("Matrix dimensions must match for element-wise operations.");
+        }
+
+        int rows() const { return left.rows(); }
+        int cols() const { return left.cols(); }
+        value_type operator()(int i, int j) const { return Op::apply(left(i, j), right(i, j)); }
+        bool aliases(const value_type *b, const value_type *e) const { return left.aliases(b, e) || right.aliases(b, e); }
+    };
+
+    struct Add { template <class T> static T apply(T a, T b) { return a + b; } };
+    struct Subtract { template <class T> static T apply(T a, T b) { return a - b; } };
+
+    template <class E>
+    class Scaled : public Expression<Scaled<E>> {
+        E inner;
+        typename E::value_type factor;
+
+        public:
+        using value_type = typename E::value_type;
+        Scaled(const E& e, value_type s) : inner(e), factor(s) {}
+
+        int rows() const { return inner.rows(); }
+        int cols() const { return inner.cols(); }
+        value_type operator()(int i, int j) const { return factor * inner(i, j); }
+        bool aliases(const value_type *b, const value_type *e) const { return inner.aliases(b, e); }
+    };
+
+    template <class E>
+    class Transposed : public Expression<Transposed<E>> {
+        E inner;
+
+        public:
+        using value_type = typename E::value_type;
+        explicit Transposed(const E& e) : inner(e) {}
+
+        int rows() const { return inner.cols(); }
+        int cols() const { return inner.rows(); }
+        value_type operator()(int i, int j) const { return inner(j, i); }
+        bool aliases(const value_type *b, const value_type *e) const { return inner.aliases(b, e); }
+    };
+
+    // matrix product; element access is an inner product so a product
+    // nested in an element-wise tree still needs no temporary, while a
+    // product at the root is evaluated by the kernels in evaluate()
+    template <class L, class R>
+    class Product : public Expression<Product<L, R>> {
+        L left;
+        R right;
+
+        public:
+        using value_type = typename L::value_type;
+        Product(const L& l, const R& r) : left(l), right(r) {
+            if (l.cols() != r.rows())
+                throw std::invalid_argument("Columns of first matrix must be equal to Rows of the second matrix.");
+        }
+
+        int rows() const { return left.rows(); }
+        int cols() const { return right.cols(); }
+        const L& lhs() const { return left; }
+        const R& rhs() const { return right; }
+
+        value_type operator()(int i, int j) const {
+            value_type sum = value_type(0);
+            for (int k = 0; k < left.cols(); k++)
+                sum += left(i, k) * right(k, j);
+            return sum;
+        }
+        bool aliases(const value_type *b, const value_type *e) const { return left.aliases(b, e) || right.aliases(b, e); }
+    };
+
+    // TRAITS
+    template <class E> struct IsRef : std::false_type {};
+    template <class T> struct IsRef<Ref<T>> : std::true_type {};
+    template <class E> struct IsIdentity : std::false_type {};
+    template <class T> struct IsIdentity<Identity<T>> : std::true_type {};
+    template <class E> struct IsOnes : std::false_type {};
+    template <class T> struct IsOnes<Ones<T>> : std::true_type {};
+    template <class E> struct IsProduct : std::false_type {};
+    template <class L, class R> struct IsProduct<Product<L, R>> : std::true_type {};
+
+    // FACTORIES
+    template <class T>
+    Ref<T> lazy(const ConstMatrixView<T>& view) {
+        return Ref<T>(view);
+    }
+
+    template <class T, int Rows, int Cols>
+    Ref<T> lazy(const Matrix<T, Rows, Cols>& matrix) {
+        return Ref<T>(matrix.view());
+    }
+
+    template <class T>
+    Identity<T> identity(int size) {
+        return Identity<T>(size);
+    }
+
+    template <class T>
+    Ones<T> ones(int rows, int cols) {
+        return Ones<T>(rows, cols);
+    }
+
+    // OPERATORS
+    template <class L, class R>
+    Binary<L, R, Add> operator + (const Expression<L>& l, const Expression<R>& r) {
+        return Binary<L, R, Add>(l.derived(), r.derived());
+    }
+
+    template <class L, class R>
+    Binary<L, R, Subtract> operator - (const Expression<L>& l, const Expression<R>& r) {
+        return Binary<L, R, Subtract>(l.derived(), r.derived());
+    }
+
+    template <class L, class R>
+    Product<L, R> operator * (const Expression<L>& l, const Expression<R>& r) {
+        return Product<L, R>(l.derived(), r.derived());
+    }
+
+    template <class E>
+    Scaled<E> operator * (const Expression<E>& e, typename E::value_type s) {
+        return Scaled<E>(e.derived(), s);
+    }
+
+    template <class E>
+    Scaled<E> operator * (typename E::value_type s, const Expression<E>& e) {
+        return Scaled<E>(e.derived(), s);
+    }
+
+    // transposes are pushed down to the leaves: (AB)^T = B^T A^T, and a
+    // transposed view is the same view with its strides swapped
+    template <class E>
+    auto transpose(const Expression<E>& e) {
+        const E& x = e.derived();
+        if constexpr (IsRef<E>::value)
+            return Ref<typename E::value_type>(x.view().transpose());
+        else if constexpr (IsIdentity<E>::value)
+            return x;
+        else if constexpr (IsOnes<E>::value)
+            return Ones<typename E::value_type>(x.cols(), x.rows());
+        else if constexpr (IsProduct<E>::value)
+            return transpose(x.rhs()) * transpose(x.lhs());
+        else
+            return Transposed<E>(x);
+    }
+
+    // EVALUATION
+    template <class T, class E>
+    void assignElements(const MatrixView<T>& dest, const E& e) {
+        for (int i = 0; i < dest.getRows(); i++)
+            for (int j = 0; j < dest.getCols(); j++)
+                dest(i, j) = e(i, j);
+    }
+
+    // a view of the operand, evaluated into storage only when it is compound
+    template <class T, class E>
+    ConstMatrixView<T> operandView(const E& e, std::vector<T>& storage) {
+        if constexpr (IsRef<E>::value) {
+            return e.view();
+        } else {
+            storage.assign(static_cast<size_t>(e.rows()) * e.cols(), T(0));
+            MatrixView<T> tmp(storage.data(), e.rows(), e.cols(), e.cols());
+            assignElements(tmp, e);
+            return tmp;
+        }
+    }
+
+    // dest = A * B, dest rows contiguous (a Matrix)
+    template <class T>
+    void multiplyInto(const MatrixView<T>& dest, const ConstMatrixView<T>& A, const ConstMatrixView<T>& B) {
+        dest.fill(T(0));
+        if constexpr (std::is_same_v<T, double>) {
+            if (B.getCols() == 1 && A.hasContiguousRows()) {
+                std::vector<double> x(B.getRows()), y(A.getRows(), 0.0);
+                for (int k = 0; k < B.getRows(); k++)
+                    x[k] = B(k, 0);
+                simd::active().gemv(A.getRows(), A.getCols(), A.getData(), static_cast<int>(A.getRowStride()), x.data(), y.data());
+                for (int i = 0; i < A.getRows(); i++)
+                    dest(i, 0) = y[i];
+                return;
+            }
+        }
+        gemm::multiply(A.getRows(), B.getCols(), A.getCols(),
+            A.getData(), A.getRowStride(), A.getColStride(),
+            B.getData(), B.getRowStride(), B.getColStride(),
+            dest.getData(), static_cast<int>(dest.getRowStride()));
+    }
+
+    template <class T, class L, class R>
+    void evaluateProduct(const MatrixView<T>& dest, const Product<L, R>& p) {
+        const L& l = p.lhs();
+        const R& r = p.rhs();
+        if constexpr (IsIdentity<L>::value) {
+            assignElements(dest, r);
+        } else if constexpr (IsIdentity<R>::value) {
+            assignElements(dest, l);
+        } else if constexpr (IsOnes<R>::value) {
+            // every column of X * ones is the row sums of X
+            for (int i = 0; i < dest.getRows(); i++) {
+                T sum = T(0);
+                for (int k = 0; k < l.cols(); k++)
+                    sum += l(i, k);
+                for (int j = 0; j < dest.getCols(); j++)
+                    dest(i, j) = sum;
+            }
+        } else if constexpr (IsOnes<L>::value) {
+            // every row of ones * X is the column sums of X
+            if (dest.getRows() == 0)
+                return;
+            for (int j = 0; j < dest.getCols(); j++)
+                dest(0, j) = T(0);
+            for (int k = 0; k < r.rows(); k++)
+                for (int j = 0; j < dest.getCols(); j++)
+                    dest(0, j) += r(k, j);
+            for (int i = 1; i < dest.getRows(); i++)
+                for (int j = 0; j < dest.getCols(); j++)
+                    dest(i, j) = dest(0, j);
+        } else {
+            std::vector<T> leftStorage, rightStorage;
+            ConstMatrixView<T> A = operandView(l, leftStorage);
+            ConstMatrixView<T> B = operandView(r, rightStorage);
+            multiplyInto(dest, A, B);
+        }
+    }
+
+    // dest = e; dest must have e's shape, contiguous rows and must not
+    // overlap any leaf of e (Matrix checks this before calling)
+    template <class T, class E>
+    void evaluate(const MatrixView<T>& dest, const E& e) {
+        if (dest.getRows() != e.rows() || dest.getCols() != e.cols())
+            throw std::invalid_argument("Expression and destination dimensions must match.");
+        if constexpr (IsProduct<E>::value)
+            evaluateProduct(dest, e);
+        else
+            assignElements(dest, e);
+    }
+}
@@ -0,0 +1,207 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "matrix.hpp"
+#include "transitionMatrix.hpp"
+#include "simdKernels.hpp"
+
+class MatrixPowerCache {
+    /* answers pi(k) = pi(0) P^k for large k without k sequential steps.
+     The squares P^(2^j) are built by repeated squaring (one GEMM each)
+     and kept, so with k = sum of 2^j over the set bits of k
+        pi(k) = pi(0) P^(2^j1) P^(2^j2) ...
+     costs one vector x matrix product per set bit, O(S^2 log k).
+     Every square is a dense S x S matrix, so the cache holds at most
+     memoryLimit bytes of them: P itself stays, the least recently used
+     square goes first, and an evicted square is rebuilt from the largest
+     lower one still cached.
+     P^(2^j) of an absorbing chain converges to the absorption matrix;
+     once two consecutive squares agree to the tolerance, every higher
+     power is taken to be equal to the last one, so even k near 2^63
+     stops after that many squarings */
+    struct Entry {
+        Matrix<double> power;
+        std::uint64_t lastUse;
+    };
+
+    int states;
+    std::size_t memoryLimit;
+    double tolerance;
+    std::map<int, Entry> cache; // j -> P^(2^j), j = 0 is never evicted
+    int stableExponent;         // P^(2^j) = P^(2^stableExponent) for j beyond it, -1 if unknown
+    Matrix<double> spare;       // buffer of the last evicted square, the next square is built in it
+    std::uint64_t clock;
+    long long hits, misses;
+
+    std::size_t bytesPerPower() const {
+        return static_cast<std::size_t>(states) * cache.at(0).power.getStride() * sizeof(double);
+    }
+
+    // drops least recently used squares until one more fits, keeping j = 0 and pinned
+    void makeRoom(int pinned) {
+        while ((cache.size() + 1) * bytesPerPower() > memoryLimit) {
+            auto victim = cache.end();
+            for (auto it = cache.begin(); it != cache.end(); ++it) {
+                if (it->first == 0 || it->first == pinned)
+                    continue;
+                if (victim == cache.end() || it->second.lastUse < victim->second.lastUse)
+                    victim = it;
+            }
+            if (victim == cache.end())
+                throw std::runtime_error("Memory limit leaves no room for the next square.");
+            spare = std::move(victim->second.power);
+            cache.erase(victim);
+        }
+    }
+
+    // squaring doubles the row-sum error of a stochastic matrix, so every
+    // square is scaled back to unit row sums before it is reused
+    static void normalizeRows(Matrix<double>& a) {
+        for (int i = 0; i < a.getRows(); i++) {
+            double sum = 0.0;
+            for (int j = 0; j < a.getCols(); j++)
+                sum += a[i][j];
+            if (sum > 0.0)
+                simd::active().scale(a.getCols(), 1.0 / sum, a[i]);
+        }
+    }
+
+    static double maxDifference(const Matrix<double>& a, const Matrix<double>& b) {
+        double worst = 0.0;
+        for (int i = 0; i < a.getRows(); i++) {
+            const double *x = a[i], *y = b[i];
+            for (int j = 0; j < a.getCols(); j++)
+                worst = std::max(worst, std::abs(x[j] - y[j]));
+        }
+        return worst;
+    }
+
+    public:
+    // P must be square and row-stochastic; the limit counts P itself
+    explicit MatrixPowerCache(const Matrix<double>& transitions, std::size_t memoryLimitBytes = std::size_t(256) << 20,
+        double convergenceTolerance = 1e-15)
+        : states(transitions.getRows()), memoryLimit(memoryLimitBytes), tolerance(convergenceTolerance),
+        stableExponent(-1), clock(0), hits(0), misses(0) {
+        if (transitions.getRows() != transitions.getCols() || states == 0)
+            throw std::invalid_argument("Transition matrix must be square and non-empty.");
+        cache.emplace(0, Entry{transitions, 0});
+        // P, one cached square and the one being built
+        if (3 * bytesPerPower() > memoryLimit)
+            throw std::invalid_argument("Memory limit must hold at least three copies of the transition matrix.");
+    }
+
+    explicit MatrixPowerCache(const TransitionMatrix& chain, std::size_t memoryLimitBytes = std::size_t(256) << 20,
+        double convergenceTolerance = 1e-15)
+        : MatrixPowerCache(chain.getTransitionMatrix(), memoryLimitBytes, convergenceTolerance) {}
+
+    // P^(2^j), built or rebuilt on demand
+    const Matrix<double>& power(int j) {
+        if (j < 0 || j > 62)
+            throw std::out_of_range("Exponent of the square must lie in 0 .. 62.");
+        if (stableExponent >= 0)
+            j = std::min(j, stableExponent);
+
+        auto found = cache.find(j);
+        if (found != cache.end()) {
+            hits++;
+            found->second.lastUse = ++clock;
+            return found->second.power;
+        }
+        misses++;
+
+        // square up from the largest lower power still cached
+        auto base = std::prev(cache.lower_bound(j));
+        int i = base->first;
+        base->second.lastUse = ++clock;
+        while (i < j) {
+            makeRoom(i);
+            const Matrix<double>& current = cache.at(i).power;
+            // evaluated straight into the spare buffer when it has the shape
+            spare = expr::lazy(current) * expr::lazy(current);
+            normalizeRows(spare);
+            if (stableExponent < 0 && maxDifference(spare, current) <= tolerance) {
+                // P^(2^i) has converged, later squares repeat it
+                stableExponent = i;
+                return cache.at(i).power;
+            }
+            i++;
+            cache[i] = Entry{std::move(spare), ++clock};
+        }
+        return cache.at(j).power;
+    }
+
+    // pi(0) P^k for a distribution over all states
+    std::vector<double> distribution(const std::vector<double>& initial, std::uint64_t k) {
+        if (static_cast<int>(initial.size()) != states)
+            throw std::invalid_argument("Initial distribution must have one entry per state.");
+        std::vector<double> x = initial, y(states);
+        for (int j = 0; k != 0; j++, k >>= 1) {
+            if (!(k & 1))
+                continue;
+            const Matrix<double>& square = power(j);
+            std::fill(y.begin(), y.end(), 0.0);
+            // row vector times matrix: y = square^T x
+            simd::active().gemvTranspose(states, states, square.getData(), square.getStride(), x.data(), y.data());
+            x.swap(y);
+            if (stableExponent >= 0 && j >= stableExponent) {
+                // x has reached the absorption limit, further factors leave it unchanged
+                break;
+            }
+        }
+        return x;
+    }
+
+    // all probability on one start block
+    std::vector<double> distribution(int startBlock, std::uint64_t k) {
+        if (startBlock < 0 || startBlock >= states)
+            throw std::out_of_range("Start block must lie on the board.");
+        std::vector<double> initial(states, 0.0);
+        initial[startBlock] = 1.0;
+        return distribution(initial, k);
+    }
+
+    // mass in the absorbing (winning) block after k turns
+    double winProbability(int startBlock, std::uint64_t k) {
+        return distribution(startBlock, k)[states - 1];
+    }
+
+    // drops every square but P itself
+    void clear() {
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->first == 0)
+                ++it;
+            else
+                it = cache.erase(it);
+        }
+        spare = Matrix<double>();
+    }
+
+    std::size_t memoryUsage() const {
+        return cache.size() * bytesPerPower();
+    }
+
+    std::size_t getMemoryLimit() const {
+        return memoryLimit;
+    }
+
+    int cachedPowers() const {
+        return static_cast<int>(cache.size());
+    }
+
+    bool isCached(int j) const {
+        return cache.count(j) != 0;
+    }
+
+    long long getHits() const {
+        return hits;
+    }
+
+    long long getMisses() const {
+        return misses;
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <memory>
+
+// cache line size, every buffer starts on a line boundary so rows of
+// doubles never straddle two lines at the beginning of the buffer
+constexpr std::size_t MATRIX_ALIGNMENT = 64;
+
+template <class T>
+class MatrixStorage {
+    /* single contiguous row-major buffer of rows x stride elements
+     stride >= cols, element (i, j) lives at buffer[i * stride + j]
+     the buffer owns its memory and frees it on destruction */
+    T *buffer;
+    int rows, cols, stride;
+
+    static T* allocate(std::size_t count) {
+        if (count == 0)
+            return nullptr;
+        void *raw = ::operator new(count * sizeof(T), std::align_val_t(MATRIX_ALIGNMENT));
+        return static_cast<T*>(raw);
+    }
+
+    static void deallocate(T *ptr) {
+        if (ptr != nullptr)
+            ::operator delete(ptr, std::align_val_t(MATRIX_ALIGNMENT));
+    }
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(rows) * stride;
+    }
+
+    public:
+    MatrixStorage() : buffer(nullptr), rows(0), cols(0), stride(0) {}
+
+    MatrixStorage(int r, int c, T value = T())
+        : buffer(allocate(static_cast<std::size_t>(r) * c)), rows(r), cols(c), stride(c) {
+        std::uninitialized_fill_n(buffer, size(), value);
+    }
+
+    MatrixStorage(const MatrixStorage<T>& other)
+        : buffer(allocate(other.size())), rows(other.rows), cols(other.cols), stride(other.stride) {
+        std::uninitialized_copy_n(other.buffer, size(), buffer);
+    }
+
+    MatrixStorage(MatrixStorage<T>&& other) noexcept
+        : buffer(other.buffer), rows(other.rows), cols(other.cols), stride(other.stride) {
+        other.buffer = nullptr;
+        other.rows = other.cols = other.stride = 0;
+    }
+
+    MatrixStorage<T>& operator=(const MatrixStorage<T>& other) {
+        if (this != &other) {
+            MatrixStorage<T> copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    MatrixStorage<T>& operator=(MatrixStorage<T>&& other) noexcept {
+        if (this != &other) {
+            MatrixStorage<T> moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    ~MatrixStorage() {
+        std::destroy_n(buffer, size());
+        deallocate(buffer);
+    }
+
+    void swap(MatrixStorage<T>& other) noexcept {
+        std::swap(buffer, other.buffer);
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(stride, other.stride);
+    }
+
+    // row access, each row is cols contiguous elements starting at row * stride
+    T* row(int r) { return buffer + static_cast<std::size_t>(r) * stride; }
+    const T* row(int r) const { return buffer + static_cast<std::size_t>(r) * stride; }
+
+    T* data() { return buffer; }
+    const T* data() const { return buffer; }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getStride() const { return stride; }
+};
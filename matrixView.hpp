@@ -0,0 +1,150 @@
+#pragma once
+#include <stdexcept>
+#include <algorithm>
+
+template <class T>
+class ConstMatrixView {
+    /* non-owning, read-only window into row-major storage owned by
+     someone else (usually a Matrix). Element (i, j) lives at
+     ptr[i * rowStride + j * colStride], so blocks, single rows and
+     columns, the diagonal and the transpose are all views onto the same
+     buffer and taking one never copies. A view must not outlive the
+     storage it points into, and is invalidated when that storage is
+     reallocated */
+    const T *ptr;
+
+    protected:
+    int rows, cols;
+    long rowStride, colStride;
+
+    public:
+    ConstMatrixView() : ptr(nullptr), rows(0), cols(0), rowStride(0), colStride(1) {}
+    ConstMatrixView(const T *data, int rows, int cols, long rowStride, long colStride = 1)
+        : ptr(data), rows(rows), cols(cols), rowStride(rowStride), colStride(colStride) {}
+
+    const T& operator()(int i, int j) const {
+        return ptr[i * rowStride + j * colStride];
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    long getRowStride() const { return rowStride; }
+    long getColStride() const { return colStride; }
+    const T* getData() const { return ptr; }
+    bool isEmpty() const { return rows == 0 || cols == 0; }
+
+    // rows are contiguous runs of cols elements
+    bool hasContiguousRows() const { return colStride == 1; }
+
+    // SLICING
+    ConstMatrixView<T> block(int row, int col, int numRows, int numCols) const {
+        if (row < 0 || col < 0 || numRows < 0 || numCols < 0 || row + numRows > rows || col + numCols > cols)
+            throw std::out_of_range("Block exceeds the bounds of the view.");
+        return ConstMatrixView<T>(ptr + row * rowStride + col * colStride, numRows, numCols, rowStride, colStride);
+    }
+
+    ConstMatrixView<T> row(int i) const {
+        return block(i, 0, 1, cols);
+    }
+
+    ConstMatrixView<T> column(int j) const {
+        return block(0, j, rows, 1);
+    }
+
+    // main diagonal as a min(rows, cols) x 1 column
+    ConstMatrixView<T> diagonal() const {
+        return ConstMatrixView<T>(ptr, std::min(rows, cols), 1, rowStride + colStride, 1);
+    }
+
+    ConstMatrixView<T> transpose() const {
+        return ConstMatrixView<T>(ptr, cols, rows, colStride, rowStride);
+    }
+};
+
+template <class T>
+class MatrixView : public ConstMatrixView<T> {
+    /* writable counterpart of ConstMatrixView, same addressing and
+     lifetime rules; assignments write straight through to the owner.
+     Derives from the read-only view so it can be passed wherever one
+     is accepted */
+    using Base = ConstMatrixView<T>;
+    using Base::rows;
+    using Base::cols;
+    using Base::rowStride;
+    using Base::colStride;
+
+    T* mutablePtr() const {
+        return const_cast<T*>(Base::getData());
+    }
+
+    template <class Op>
+    MatrixView<T>& combine(const ConstMatrixView<T>& other, Op op) {
+        if (rows != other.getRows() || cols != other.getCols())
+            throw std::invalid_argument("View dimensions must match.");
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                op((*this)(i, j), other(i, j));
+        return *this;
+    }
+
+    public:
+    MatrixView() : Base() {}
+    MatrixView(T *data, int rows, int cols, long rowStride, long colStride = 1)
+        : Base(data, rows, cols, rowStride, colStride) {}
+
+    T& operator()(int i, int j) const {
+        return mutablePtr()[i * rowStride + j * colStride];
+    }
+
+    T* getData() const { return mutablePtr(); }
+
+    // SLICING
+    MatrixView<T> block(int row, int col, int numRows, int numCols) const {
+        if (row < 0 || col < 0 || numRows < 0 || numCols < 0 || row + numRows > rows || col + numCols > cols)
+            throw std::out_of_range("Block exceeds the bounds of the view.");
+        return MatrixView<T>(mutablePtr() + row * rowStride + col * colStride, numRows, numCols, rowStride, colStride);
+    }
+
+    MatrixView<T> row(int i) const {
+        return block(i, 0, 1, cols);
+    }
+
+    MatrixView<T> column(int j) const {
+        return block(0, j, rows, 1);
+    }
+
+    MatrixView<T> diagonal() const {
+        return MatrixView<T>(mutablePtr(), std::min(rows, cols), 1, rowStride + colStride, 1);
+    }
+
+    MatrixView<T> transpose() const {
+        return MatrixView<T>(mutablePtr(), cols, rows, colStride, rowStride);
+    }
+
+    // IN-PLACE UPDATES
+    void fill(T value) const {
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                (*this)(i, j) = value;
+    }
+
+    // element-wise copy; source and destination must not overlap
+    MatrixView<T>& assign(const ConstMatrixView<T>& other) {
+        return combine(other, [](T& a, const T& b) { a = b; });
+    }
+
+    MatrixView<T>& operator += (const ConstMatrixView<T>& other) {
+        return combine(other, [](T& a, const T& b) { a += b; });
+    }
+
+    MatrixView<T>& operator -= (const ConstMatrixView<T>& other) {
+        return combine(other, [](T& a, const T& b) { a -= b; });
+    }
+
+    MatrixView<T>& operator *= (T scalar) {
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                (*this)(i, j) *= scalar;
+        return *this;
+    }
+};
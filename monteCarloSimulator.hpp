@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+#include "jumpTable.hpp"
+#include "counterRng.hpp"
+#include "moveRules.hpp"
+
+struct SimulationResult {
+    long long games = 0;
+    long long truncatedGames = 0; // hit maxTurns before winning
+    double meanLength = 0.0;
+    double varianceLength = 0.0;
+    // lengthHistogram[t] = number of games won in exactly t turns
+    std::vector<long long> lengthHistogram;
+    // hits per block, only non-zero where a snake / ladder starts
+    std::vector<long long> snakeHits;
+    std::vector<long long> ladderHits;
+    long long totalSnakeHits = 0;
+    long long totalLadderHits = 0;
+
+    // folds another partial result into this one (Chan et al. parallel
+    // variance: exact for any split of the games between threads)
+    void merge(const SimulationResult& other) {
+        if (other.games == 0)
+            return;
+
+        const long long n = games + other.games;
+        const double delta = other.meanLength - meanLength;
+        const double m2 = varianceLength * games + other.varianceLength * other.games
+            + delta * delta * static_cast<double>(games) * other.games / n;
+        meanLength += delta * other.games / n;
+        varianceLength = m2 / n;
+        games = n;
+        truncatedGames += other.truncatedGames;
+
+        if (lengthHistogram.size() < other.lengthHistogram.size())
+            lengthHistogram.resize(other.lengthHistogram.size(), 0);
+        for (size_t t = 0; t < other.lengthHistogram.size(); t++)
+            lengthHistogram[t] += other.lengthHistogram[t];
+
+        snakeHits.resize(std::max(snakeHits.size(), other.snakeHits.size()), 0);
+        ladderHits.resize(std::max(ladderHits.size(), other.ladderHits.size()), 0);
+        for (size_t b = 0; b < other.snakeHits.size(); b++) {
+            snakeHits[b] += other.snakeHits[b];
+            ladderHits[b] += other.ladderHits[b];
+        }
+        totalSnakeHits += other.totalSnakeHits;
+        totalLadderHits += other.totalLadderHits;
+    }
+};
+
+class MonteCarloSimulator {
+    /* plays complete single-player games with the same rules as
+     TransitionMatrix (overshooting the last block wastes the turn)
+     game g draws its dice from PhiloxEngine(seed, g), so the games played
+     only depend on the seed and not on the number of threads; every
+     thread plays a contiguous range of games into its own partial result
+     and nothing is shared until the final merge, so throughput scales
+     with the number of cores (counts and histograms are identical for
+     any thread count, mean and variance up to rounding in the merge) */
+    const JumpTable& jumps;
+    int maxTurns;
+
+    static SimulationResult playGames(const JumpTable& jumps, long long firstGame, long long games,
+        std::uint64_t seed, int maxTurns) {
+
+        SimulationResult result;
+        const int totalBlocks = jumps.size();
+        const int lastBlock = totalBlocks - 1;
+        result.snakeHits.assign(totalBlocks, 0);
+        result.ladderHits.assign(totalBlocks, 0);
+
+        double mean = 0.0, m2 = 0.0;
+        long long finished = 0;
+
+        for (long long g = firstGame; g < firstGame + games; g++) {
+            // stream keyed by the game index
+            PhiloxEngine gen(seed, static_cast<std::uint64_t>(g));
+            std::uniform_int_distribution<int> dice(1, 6);
+            int position = 0;
+            int turns = 0;
+            while (position != lastBlock && turns < maxTurns) {
+                const int roll = dice(gen);
+                const int next = position + roll;
+                const int destination = rules::moveDestination(position, roll, totalBlocks, jumps);
+                turns++;
+                // jumps only resolve below the winning block
+                if (next >= lastBlock) {
+                    position = destination;
+                    continue;
+                }
+
+                if (destination < next) {
+                    result.snakeHits[next]++;
+                    result.totalSnakeHits++;
+                } else if (destination > next) {
+                    result.ladderHits[next]++;
+                    result.totalLadderHits++;
+                }
+                position = destination;
+            }
+
+            if (position != lastBlock) {
+                result.truncatedGames++;
+                continue;
+            }
+
+            // Welford running mean / variance
+            finished++;
+            const double delta = turns - mean;
+            mean += delta / finished;
+            m2 += delta * (turns - mean);
+
+            if (static_cast<int>(result.lengthHistogram.size()) <= turns)
+                result.lengthHistogram.resize(turns + 1, 0);
+            result.lengthHistogram[turns]++;
+        }
+
+        result.games = finished;
+        result.meanLength = mean;
+        result.varianceLength = finished > 0 ? m2 / finished : 0.0;
+        return result;
+    }
+
+    public:
+    // the jump table must outlive the simulator
+    explicit MonteCarloSimulator(const JumpTable& table, int maxTurnsPerGame = 100000)
+        : jumps(table), maxTurns(maxTurnsPerGame) {}
+
+    // plays `games` games; threads = 0 uses every hardware thread
+    SimulationResult run(long long games, std::uint64_t seed, int threads = 0) const {
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<int>(std::min<long long>(threads, std::max(1LL, games)));
+
+        std::vector<SimulationResult> partial(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (int t = 0; t < threads; t++) {
+            // spread the remainder over the first threads
+            const long long begin = games / threads * t + std::min<long long>(t, games % threads);
+            const long long share = games / threads + (t < games % threads ? 1 : 0);
+            workers.emplace_back([this, &partial, begin, share, seed, t]() {
+                partial[t] = playGames(jumps, begin, share, seed, maxTurns);
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        SimulationResult result;
+        for (const SimulationResult& part : partial)
+            result.merge(part);
+        return result;
+    }
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace rules {
+    // block a token on block ends up on after rolling dice, on a board of
+    // blocks blocks where destination[i] is where landing on block i leads:
+    // overshooting the last block wastes the turn, the last block is the
+    // winning block and any jump on it is ignored. The one copy of the
+    // dice rules shared by the exact chains, the compile-time boards and
+    // the simulators
+    template <class Destinations>
+    constexpr int moveDestination(int block, int dice, int blocks, const Destinations& destination) {
+        const int nextBlock = block + dice;
+        if (nextBlock > blocks - 1)
+            return block;
+        if (nextBlock == blocks - 1)
+            return nextBlock;
+        return destination[nextBlock];
+    }
+}
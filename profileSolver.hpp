@@ -0,0 +1,309 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "sparseMatrix.hpp"
+#include "matrix.hpp"
+#include "simdKernels.hpp"
+#include "luFactorization.hpp"
+#include <optional>
+#include <cstdlib>
+
+class ProfileLU {
+    /* skyline (profile / envelope) LU of a sparse matrix, no pivoting.
+     For I - Q every row only reaches the next six blocks apart from the
+     few rows that land on a snake or ladder, so the envelope is a thin
+     band plus a handful of long rows (snakes, in L) and long columns
+     (ladders, in U). Fill-in never leaves the envelope, so the factors
+     take O(profile) memory and O(S * b^2) work for bandwidth b, instead
+     of O(S^2) / O(S^3) for a dense LU.
+
+     storage, all contiguous so the inner products are plain dot products:
+       row i of L:    columns rowFirst[i] .. i-1   at lower[lowerStart[i] ..]
+       column j of U: rows    colFirst[j] .. j-1   at upper[upperStart[j] ..]
+       diagonal of U: diag[i]
+
+     I - Q is a non-singular M-matrix, which guarantees every pivot of
+     an unpivoted LU is positive, so no row exchanges are needed */
+    int n;
+    std::vector<int> rowFirst, colFirst;
+    std::vector<long> lowerStart, upperStart;
+    std::vector<double> lower, upper, diag;
+
+    double& L(int i, int j) { return lower[lowerStart[i] + (j - rowFirst[i])]; }
+    double& U(int i, int j) { return upper[upperStart[j] + (i - colFirst[j])]; }
+
+    static double dot(int count, const double *x, const double *y) {
+        return count > 0 ? simd::active().dot(count, x, y) : 0.0;
+    }
+
+    // sum over p in [from, to) of L(i, p) * U(p, j)
+    double innerProduct(int i, int j, int to) const {
+        const int from = std::max(rowFirst[i], colFirst[j]);
+        if (from >= to)
+            return 0.0;
+        const double *l = lower.data() + lowerStart[i] + (from - rowFirst[i]);
+        const double *u = upper.data() + upperStart[j] + (from - colFirst[j]);
+        return dot(to - from, l, u);
+    }
+
+    public:
+    // envelope: first non-zero column of each row (left of the
+    // diagonal) and first non-zero row of each column (above it)
+    static void envelope(const SparseMatrix<double>& A, std::vector<int>& rowFirst, std::vector<int>& colFirst) {
+        const int n = A.getRows();
+        rowFirst.resize(n);
+        colFirst.resize(n);
+        for (int i = 0; i < n; i++) {
+            rowFirst[i] = i;
+            colFirst[i] = i;
+        }
+        for (int i = 0; i < n; i++) {
+            SparseMatrix<double>::Row r = A.row(i);
+            for (int k = 0; k < r.size(); k++) {
+                const int j = r.col(k);
+                if (j < i)
+                    rowFirst[i] = std::min(rowFirst[i], j);
+                else if (j > i)
+                    colFirst[j] = std::min(colFirst[j], i);
+            }
+        }
+    }
+
+    // off-diagonal entries the factors of A would store
+    static long envelopeSize(const SparseMatrix<double>& A) {
+        std::vector<int> rowFirst, colFirst;
+        envelope(A, rowFirst, colFirst);
+        long size = 0;
+        for (int i = 0; i < A.getRows(); i++)
+            size += (i - rowFirst[i]) + (i - colFirst[i]);
+        return size;
+    }
+
+    explicit ProfileLU(const SparseMatrix<double>& A) : n(A.getRows()) {
+        if (A.getRows() != A.getCols())
+            throw std::invalid_argument("Profile LU needs a square matrix.");
+
+        envelope(A, rowFirst, colFirst);
+
+        lowerStart.resize(n + 1);
+        upperStart.resize(n + 1);
+        lowerStart[0] = upperStart[0] = 0;
+        for (int i = 0; i < n; i++) {
+            lowerStart[i + 1] = lowerStart[i] + (i - rowFirst[i]);
+            upperStart[i + 1] = upperStart[i] + (i - colFirst[i]);
+        }
+        lower.assign(lowerStart[n], 0.0);
+        upper.assign(upperStart[n], 0.0);
+        diag.assign(n, 0.0);
+
+        // scatter A into the envelope
+        for (int i = 0; i < n; i++) {
+            SparseMatrix<double>::Row r = A.row(i);
+            for (int k = 0; k < r.size(); k++) {
+                const int j = r.col(k);
+                if (j < i) L(i, j) = r.value(k);
+                else if (j > i) U(i, j) = r.value(k);
+                else diag[i] = r.value(k);
+            }
+        }
+
+        // Doolittle by bordering: step k finishes row k of L, column k of U
+        // and the pivot, using only rows / columns < k
+        for (int k = 0; k < n; k++) {
+            for (int j = rowFirst[k]; j < k; j++)
+                L(k, j) = (L(k, j) - innerProduct(k, j, j)) / diag[j];
+
+            for (int i = colFirst[k]; i < k; i++)
+                U(i, k) -= innerProduct(i, k, i);
+
+            diag[k] -= innerProduct(k, k, k);
+            if (!(diag[k] > 1e-300) && !(diag[k] < -1e-300))
+                throw std::runtime_error("Zero pivot in profile LU, the matrix needs pivoting.");
+        }
+    }
+
+    // solves A x = b
+    std::vector<double> solve(std::vector<double> b) const {
+        if (static_cast<int>(b.size()) != n)
+            throw std::invalid_argument("Right hand side must have one entry per row.");
+
+        // L y = b, row oriented
+        for (int i = 0; i < n; i++) {
+            const int width = i - rowFirst[i];
+            b[i] -= dot(width, lower.data() + lowerStart[i], b.data() + rowFirst[i]);
+        }
+
+        // U x = y, column oriented
+        for (int j = n - 1; j >= 0; j--) {
+            b[j] /= diag[j];
+            const int height = j - colFirst[j];
+            if (height > 0)
+                simd::active().axpy(height, -b[j], upper.data() + upperStart[j], b.data() + colFirst[j]);
+        }
+        return b;
+    }
+
+    Matrix<double> solve(const Matrix<double>& b) const {
+        std::vector<double> rhs(b.getRows());
+        for (int i = 0; i < b.getRows(); i++)
+            rhs[i] = b[i][0];
+        std::vector<double> x = solve(std::move(rhs));
+        Matrix<double> result(n, 1);
+        for (int i = 0; i < n; i++)
+            result[i][0] = x[i];
+        return result;
+    }
+
+    // widest reach below / above the diagonal
+    int lowerBandwidth() const {
+        int b = 0;
+        for (int i = 0; i < n; i++)
+            b = std::max(b, i - rowFirst[i]);
+        return b;
+    }
+
+    int upperBandwidth() const {
+        int b = 0;
+        for (int j = 0; j < n; j++)
+            b = std::max(b, j - colFirst[j]);
+        return b;
+    }
+
+    // stored off-diagonal entries, compare with n * n for a dense LU
+    long profileSize() const {
+        return lowerStart[n] + upperStart[n];
+    }
+
+    int size() const {
+        return n;
+    }
+};
+
+class BandedSolver {
+    /* structure-aware direct solver for I - Q.
+     Splits A = B + U V^T where B keeps the entries within the detected
+     bandwidth (the ordinary dice moves) and U V^T holds the long-range
+     snake / ladder entries grouped by column: column c of the
+     correction is U[:, c] e_c^T, so its rank k is the number of distinct
+     far destinations. Then (Sherman-Morrison-Woodbury)
+        A^-1 b = y - B^-1 U (I + V^T B^-1 U)^-1 V^T y,   y = B^-1 b
+     with B factorized by ProfileLU in O(S * b^2) and a k x k capacitance.
+     When the long entries are so few that the plain envelope of A is
+     cheaper than the n x k correction, A is profile-factorized directly */
+    int n;
+    int bandwidth;
+    std::optional<ProfileLU> direct;   // profile LU of A itself
+    std::optional<ProfileLU> band;     // profile LU of the band part B
+    std::vector<int> correctionCols;   // far column of each correction term
+    std::vector<std::vector<double>> BinvU; // B^-1 U, one vector per column
+    LUFactorization<double> capacitance;
+
+    // bandwidth of the "ordinary" moves: the largest |i - j| that occurs
+    // in at least an eighth of the rows (dice reach every row, a long
+    // jump only a handful)
+    static int detectBandwidth(const SparseMatrix<double>& A) {
+        const int maxTracked = 64;
+        std::vector<int> count(maxTracked + 1, 0);
+        for (int i = 0; i < A.getRows(); i++) {
+            SparseMatrix<double>::Row r = A.row(i);
+            for (int k = 0; k < r.size(); k++) {
+                const int d = std::abs(r.col(k) - i);
+                if (d <= maxTracked)
+                    count[d]++;
+            }
+        }
+        int b = 0;
+        for (int d = 1; d <= maxTracked; d++) {
+            if (count[d] >= std::max(1, A.getRows() / 8))
+                b = d;
+        }
+        return b;
+    }
+
+    public:
+    enum class Strategy { Auto, Profile, LowRank };
+
+    explicit BandedSolver(const SparseMatrix<double>& A, Strategy strategy = Strategy::Auto, int bandwidthHint = -1)
+        : n(A.getRows()), bandwidth(bandwidthHint >= 0 ? bandwidthHint : detectBandwidth(A)) {
+
+        // split into band part and long-range columns
+        SparseMatrix<double> B(n, n);
+        std::vector<std::vector<std::pair<int, double>>> farColumns(n);
+        std::vector<std::pair<int, double>> entries;
+        long farCount = 0;
+        for (int i = 0; i < n; i++) {
+            entries.clear();
+            SparseMatrix<double>::Row r = A.row(i);
+            for (int k = 0; k < r.size(); k++) {
+                if (std::abs(r.col(k) - i) <= bandwidth) {
+                    entries.emplace_back(r.col(k), r.value(k));
+                } else {
+                    farColumns[r.col(k)].emplace_back(i, r.value(k));
+                    farCount++;
+                }
+            }
+            B.appendRow(entries);
+        }
+
+        for (int c = 0; c < n; c++) {
+            if (!farColumns[c].empty())
+                correctionCols.push_back(c);
+        }
+        const long rank = static_cast<long>(correctionCols.size());
+
+        // the correction costs n * rank memory and rank band solves
+        bool profile = strategy == Strategy::Profile || farCount == 0;
+        if (strategy == Strategy::Auto)
+            profile = profile || ProfileLU::envelopeSize(A) <= ProfileLU::envelopeSize(B) + n * rank;
+        if (profile) {
+            direct.emplace(A);
+            correctionCols.clear();
+            return;
+        }
+
+        band.emplace(B);
+        BinvU.reserve(rank);
+        for (int c : correctionCols) {
+            std::vector<double> u(n, 0.0);
+            for (const auto& [row, value] : farColumns[c])
+                u[row] = value;
+            BinvU.push_back(band->solve(std::move(u)));
+        }
+
+        // capacitance I + V^T B^-1 U, entry (a, b) = (B^-1 U_b)[col_a]
+        Matrix<double> C = Matrix<double>::identity(rank);
+        for (int a = 0; a < rank; a++)
+            for (int b = 0; b < rank; b++)
+                C[a][b] += BinvU[b][correctionCols[a]];
+        capacitance.factorize(std::move(C));
+    }
+
+    std::vector<double> solve(const std::vector<double>& b) const {
+        if (direct)
+            return direct->solve(b);
+
+        std::vector<double> y = band->solve(b);
+        const int rank = static_cast<int>(correctionCols.size());
+        Matrix<double> Vy(rank, 1);
+        for (int a = 0; a < rank; a++)
+            Vy[a][0] = y[correctionCols[a]];
+        Matrix<double> z = capacitance.solve(Vy);
+        for (int a = 0; a < rank; a++)
+            simd::active().axpy(n, -z[a][0], BinvU[a].data(), y.data());
+        return y;
+    }
+
+    int getBandwidth() const {
+        return bandwidth;
+    }
+
+    // number of low-rank correction terms (0 when A was factorized directly)
+    int correctionRank() const {
+        return static_cast<int>(correctionCols.size());
+    }
+
+    bool usesCorrection() const {
+        return !direct.has_value();
+    }
+};
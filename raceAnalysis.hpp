@@ -0,0 +1,232 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <cmath>
+#include <thread>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "jumpTable.hpp"
+#include "transitionMatrix.hpp"
+#include "absorptionTime.hpp"
+#include "counterRng.hpp"
+#include "moveRules.hpp"
+
+struct RaceSimulationResult {
+    long long games = 0;
+    long long truncatedGames = 0;     // nobody won within maxRounds
+    std::vector<long long> seatWins;  // seatWins[i] = games won by seat i
+    double meanRounds = 0.0;
+    double meanMoves = 0.0;
+
+    void merge(const RaceSimulationResult& other) {
+        const long long n = games + other.games;
+        if (n > 0) {
+            meanRounds = (meanRounds * games + other.meanRounds * other.games) / n;
+            meanMoves = (meanMoves * games + other.meanMoves * other.games) / n;
+        }
+        games = n;
+        truncatedGames += other.truncatedGames;
+        seatWins.resize(std::max(seatWins.size(), other.seatWins.size()), 0);
+        for (size_t i = 0; i < other.seatWins.size(); i++)
+            seatWins[i] += other.seatWins[i];
+    }
+};
+
+class RaceAnalysis {
+    /* p players race on the same board without interacting. Seats move
+     in order 0 .. p-1 every round and the first to reach the winning
+     block ends the game, so with T_i the first-passage time of seat i
+     (its number of own moves), f_i its PMF and S_i(k) = P(T_i > k),
+     seat i wins in round k when T_i = k, every earlier seat is still
+     playing after k moves and every later one after k - 1:
+        P(seat i wins in round k) = f_i(k) prod_{j<i} S_j(k) prod_{j>i} S_j(k-1)
+     The players are independent, so the race only needs the one-player
+     distribution of every distinct start block (one sweep each, shared
+     by the seats that start there) and the products over the other
+     seats come from prefix / suffix products, O(p T) for a horizon of T
+     rounds instead of a chain over S^p joint states.
+     The game lasts past round k when every seat does:
+        E[rounds] = sum_k prod_j S_j(k)
+     and a win by seat i in round k takes (k - 1) p + i + 1 moves */
+    std::vector<int> starts;
+    int seats;
+    int horizonRounds;
+    std::vector<double> winProbabilities;
+    std::vector<std::vector<double>> seatWinPMF; // [seat][round]
+    std::vector<double> roundsPMF;               // P(game ends in round k)
+    double expectedRounds;
+    double expectedMoves;
+    double unresolved; // P(nobody won within the horizon)
+    JumpTable jumps;
+
+    public:
+    // every seat has its own start block, seat 0 moves first
+    RaceAnalysis(const TransitionMatrix& chain, std::vector<int> startBlocks, double tailTolerance = 1e-12)
+        : starts(std::move(startBlocks)), seats(static_cast<int>(starts.size())), horizonRounds(0),
+        expectedRounds(0.0), expectedMoves(0.0), unresolved(0.0), jumps(chain.getJumpTable()) {
+        if (seats < 1)
+            throw std::invalid_argument("A race needs at least one player.");
+
+        // one sweep per distinct start block
+        std::map<int, AbsorptionTimeDistribution> sweeps;
+        for (int start : starts) {
+            if (!sweeps.count(start))
+                sweeps.emplace(start, AbsorptionTimeDistribution(chain, start, tailTolerance));
+        }
+        std::vector<const AbsorptionTimeDistribution*> player(seats);
+        for (int i = 0; i < seats; i++) {
+            player[i] = &sweeps.at(starts[i]);
+            horizonRounds = std::max(horizonRounds, player[i]->horizon());
+        }
+
+        winProbabilities.assign(seats, 0.0);
+        seatWinPMF.assign(seats, std::vector<double>(horizonRounds + 1, 0.0));
+        roundsPMF.assign(horizonRounds + 1, 0.0);
+        std::vector<double> prefix(seats + 1), suffix(seats + 1);
+        for (int k = 1; k <= horizonRounds; k++) {
+            // prefix[i] = prod_{j<i} S_j(k), suffix[i] = prod_{j>=i} S_j(k-1)
+            prefix[0] = 1.0;
+            for (int j = 0; j < seats; j++)
+                prefix[j + 1] = prefix[j] * player[j]->survival(k);
+            suffix[seats] = 1.0;
+            for (int j = seats - 1; j >= 0; j--)
+                suffix[j] = suffix[j + 1] * player[j]->survival(k - 1);
+
+            double ended = 0.0;
+            for (int i = 0; i < seats; i++) {
+                const double win = player[i]->pmf(k) * prefix[i] * suffix[i + 1];
+                seatWinPMF[i][k] = win;
+                winProbabilities[i] += win;
+                ended += win;
+                expectedMoves += win * (static_cast<double>(k - 1) * seats + i + 1);
+            }
+            roundsPMF[k] = ended;
+            // P(game lasts past round k - 1)
+            expectedRounds += suffix[0];
+        }
+        unresolved = prefix[seats];
+    }
+
+    // p players on the start block
+    RaceAnalysis(const TransitionMatrix& chain, int players, int startBlock = 0, double tailTolerance = 1e-12)
+        : RaceAnalysis(chain, std::vector<int>(std::max(players, 0), startBlock), tailTolerance) {}
+
+    int getPlayers() const {
+        return seats;
+    }
+
+    // P(seat wins)
+    double winProbability(int seat) const {
+        return winProbabilities.at(seat);
+    }
+
+    const std::vector<double>& getWinProbabilities() const {
+        return winProbabilities;
+    }
+
+    // P(seat wins in round k)
+    double winProbability(int seat, int round) const {
+        if (round < 0)
+            throw std::out_of_range("Round must not be negative.");
+        return round <= horizonRounds ? seatWinPMF.at(seat)[round] : 0.0;
+    }
+
+    // P(game ends in round k)
+    const std::vector<double>& getRoundsPMF() const {
+        return roundsPMF;
+    }
+
+    double getExpectedRounds() const {
+        return expectedRounds;
+    }
+
+    // total moves made by all players together
+    double getExpectedMoves() const {
+        return expectedMoves;
+    }
+
+    // probability mass beyond the horizon of the sweeps
+    double unresolvedProbability() const {
+        return unresolved;
+    }
+
+    int horizon() const {
+        return horizonRounds;
+    }
+
+    // plays whole races with the same rules; game g draws from
+    // PhiloxEngine(seed, g), so the result does not depend on threads
+    RaceSimulationResult simulate(long long games, std::uint64_t seed, int threads = 0, int maxRounds = 100000) const {
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<int>(std::min<long long>(threads, std::max(1LL, games)));
+
+        std::vector<RaceSimulationResult> partial(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            const long long begin = games / threads * t + std::min<long long>(t, games % threads);
+            const long long share = games / threads + (t < games % threads ? 1 : 0);
+            workers.emplace_back([this, begin, share, seed, maxRounds, &partial, t]() {
+                RaceSimulationResult& result = partial[t];
+                result.seatWins.assign(seats, 0);
+                const int lastBlock = jumps.size() - 1;
+                std::vector<int> position(seats);
+                double rounds = 0.0, moves = 0.0;
+                long long finished = 0;
+
+                for (long long g = begin; g < begin + share; g++) {
+                    PhiloxEngine gen(seed, static_cast<std::uint64_t>(g));
+                    std::uniform_int_distribution<int> dice(1, 6);
+                    position = starts;
+                    int winner = -1, round = 0;
+                    while (winner < 0 && round < maxRounds) {
+                        round++;
+                        for (int i = 0; i < seats; i++) {
+                            position[i] = rules::moveDestination(position[i], dice(gen), lastBlock + 1, jumps);
+                            if (position[i] == lastBlock) {
+                                winner = i;
+                                break;
+                            }
+                        }
+                    }
+                    if (winner < 0) {
+                        result.truncatedGames++;
+                        continue;
+                    }
+                    result.seatWins[winner]++;
+                    finished++;
+                    rounds += round;
+                    moves += static_cast<double>(round - 1) * seats + winner + 1;
+                }
+                result.games = finished;
+                result.meanRounds = finished > 0 ? rounds / finished : 0.0;
+                result.meanMoves = finished > 0 ? moves / finished : 0.0;
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        RaceSimulationResult total;
+        total.seatWins.assign(seats, 0);
+        for (const RaceSimulationResult& result : partial)
+            total.merge(result);
+        return total;
+    }
+
+    // largest |simulated - exact| seat win share in binomial standard
+    // errors, values of a few are expected from sampling alone
+    double maxDeviation(const RaceSimulationResult& simulated) const {
+        if (simulated.games <= 0)
+            throw std::invalid_argument("Simulation has no finished games.");
+        double worst = 0.0;
+        for (int i = 0; i < seats; i++) {
+            const double p = winProbabilities[i];
+            const double error = std::sqrt(std::max(p * (1.0 - p), 1e-300) / simulated.games);
+            const double share = static_cast<double>(simulated.seatWins.at(i)) / simulated.games;
+            worst = std::max(worst, std::abs(share - p) / error);
+        }
+        return worst;
+    }
+};
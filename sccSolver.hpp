@@ -0,0 +1,216 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "sparseMatrix.hpp"
+#include "luFactorization.hpp"
+#include "iterativeSolvers.hpp"
+
+class SCCSolver {
+    /* block-triangular solver for A x = b (A = I - Q).
+     Block i depends on block j when A(i, j) != 0, i.e. a move from i can
+     reach j. Tarjan's algorithm splits this graph into strongly connected
+     components and emits them successors-first (reverse topological
+     order), which is exactly the order in which they can be solved:
+     when a component is reached every block it can move to outside of
+     it already has its value, so
+         A_cc x_c = b_c - sum over earlier components d of A_cd x_d
+     Components of one block are a division, small ones a dense LU
+     (factorized once, reused for every right hand side) and large ones
+     an ILU(0) preconditioned BiCGSTAB on their sparse diagonal block */
+    struct Component {
+        std::vector<int> blocks;       // sorted ascending
+        LUFactorization<double> dense; // when blocks.size() in (1, denseLimit]
+        SparseMatrix<double> sparse;   // when blocks.size() > denseLimit
+    };
+
+    const SparseMatrix<double>& A;
+    std::vector<Component> components;     // in solve order
+    std::vector<int> componentOf;
+    std::vector<int> localIndex;           // position of a block inside its component
+    int denseLimit;
+    IterativeOptions sparseOptions;
+
+    // iterative Tarjan so million-block chains do not overflow the stack
+    void findComponents() {
+        const int n = A.getRows();
+        std::vector<int> index(n, -1), low(n, 0), stack;
+        std::vector<char> onStack(n, 0);
+        std::vector<std::pair<int, int>> callStack; // (block, next edge offset)
+        int counter = 0;
+
+        for (int root = 0; root < n; root++) {
+            if (index[root] != -1)
+                continue;
+
+            callStack.emplace_back(root, 0);
+            while (!callStack.empty()) {
+                auto& [v, edge] = callStack.back();
+                if (edge == 0 && index[v] == -1) {
+                    index[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    onStack[v] = 1;
+                }
+
+                SparseMatrix<double>::Row r = A.row(v);
+                bool descended = false;
+                while (edge < r.size()) {
+                    const int w = r.col(edge++);
+                    if (w == v)
+                        continue;
+                    if (index[w] == -1) {
+                        callStack.emplace_back(w, 0);
+                        descended = true;
+                        break;
+                    }
+                    if (onStack[w])
+                        low[v] = std::min(low[v], index[w]);
+                }
+                if (descended)
+                    continue;
+
+                // v is finished: close its component if it is the root
+                const int finished = v;
+                if (low[finished] == index[finished]) {
+                    Component component;
+                    int w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        onStack[w] = 0;
+                        component.blocks.push_back(w);
+                    } while (w != finished);
+                    std::sort(component.blocks.begin(), component.blocks.end());
+                    components.push_back(std::move(component));
+                }
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    const int parent = callStack.back().first;
+                    low[parent] = std::min(low[parent], low[finished]);
+                }
+            }
+        }
+    }
+
+    void factorizeComponents() {
+        const int n = A.getRows();
+        componentOf.assign(n, -1);
+        localIndex.assign(n, -1);
+        for (int c = 0; c < static_cast<int>(components.size()); c++) {
+            const std::vector<int>& blocks = components[c].blocks;
+            for (int k = 0; k < static_cast<int>(blocks.size()); k++) {
+                componentOf[blocks[k]] = c;
+                localIndex[blocks[k]] = k;
+            }
+        }
+
+        for (int c = 0; c < static_cast<int>(components.size()); c++) {
+            Component& component = components[c];
+            const int size = static_cast<int>(component.blocks.size());
+            if (size == 1)
+                continue;
+
+            // diagonal block A_cc in local numbering
+            if (size <= denseLimit) {
+                Matrix<double> block(size, size, 0.0);
+                for (int k = 0; k < size; k++) {
+                    SparseMatrix<double>::Row r = A.row(component.blocks[k]);
+                    for (int e = 0; e < r.size(); e++) {
+                        if (componentOf[r.col(e)] == c)
+                            block[k][localIndex[r.col(e)]] = r.value(e);
+                    }
+                }
+                component.dense.factorize(std::move(block));
+            } else {
+                component.sparse = SparseMatrix<double>(size, size);
+                std::vector<std::pair<int, double>> entries;
+                for (int k = 0; k < size; k++) {
+                    entries.clear();
+                    SparseMatrix<double>::Row r = A.row(component.blocks[k]);
+                    for (int e = 0; e < r.size(); e++) {
+                        if (componentOf[r.col(e)] == c)
+                            entries.emplace_back(localIndex[r.col(e)], r.value(e));
+                    }
+                    component.sparse.appendRow(entries);
+                }
+            }
+        }
+    }
+
+    public:
+    // A must outlive the solver
+    explicit SCCSolver(const SparseMatrix<double>& matrix, int denseBlockLimit = 256,
+        IterativeOptions largeBlockOptions = IterativeOptions())
+        : A(matrix), denseLimit(denseBlockLimit), sparseOptions(largeBlockOptions) {
+        if (A.getRows() != A.getCols())
+            throw std::invalid_argument("SCC solver needs a square matrix.");
+        findComponents();
+        factorizeComponents();
+    }
+
+    std::vector<double> solve(const std::vector<double>& b) const {
+        const int n = A.getRows();
+        if (static_cast<int>(b.size()) != n)
+            throw std::invalid_argument("Right hand side must have one entry per row.");
+
+        std::vector<double> x(n, 0.0);
+        for (int c = 0; c < static_cast<int>(components.size()); c++) {
+            const Component& component = components[c];
+            const int size = static_cast<int>(component.blocks.size());
+
+            // right hand side with the already solved components moved over
+            std::vector<double> rhs(size);
+            double diagonal = 0.0;
+            for (int k = 0; k < size; k++) {
+                const int i = component.blocks[k];
+                double sum = b[i];
+                SparseMatrix<double>::Row r = A.row(i);
+                for (int e = 0; e < r.size(); e++) {
+                    if (componentOf[r.col(e)] != c)
+                        sum -= r.value(e) * x[r.col(e)];
+                    else if (size == 1)
+                        diagonal = r.value(e);
+                }
+                rhs[k] = sum;
+            }
+
+            if (size == 1) {
+                if (diagonal == 0.0)
+                    throw std::runtime_error("Singular diagonal block in SCC solve.");
+                x[component.blocks[0]] = rhs[0] / diagonal;
+                continue;
+            }
+
+            std::vector<double> local;
+            if (size <= denseLimit) {
+                Matrix<double> column(size, 1);
+                for (int k = 0; k < size; k++)
+                    column[k][0] = rhs[k];
+                Matrix<double> solved = component.dense.solve(column);
+                local.resize(size);
+                for (int k = 0; k < size; k++)
+                    local[k] = solved[k][0];
+            } else {
+                IterativeResult result = iterative::bicgstab(component.sparse, rhs, sparseOptions);
+                if (!result.converged)
+                    throw std::runtime_error("Iterative solve of a large component did not converge.");
+                local = std::move(result.x);
+            }
+
+            for (int k = 0; k < size; k++)
+                x[component.blocks[k]] = local[k];
+        }
+        return x;
+    }
+
+    int componentCount() const {
+        return static_cast<int>(components.size());
+    }
+
+    int largestComponent() const {
+        size_t largest = 0;
+        for (const Component& component : components)
+            largest = std::max(largest, component.blocks.size());
+        return static_cast<int>(largest);
+    }
+};
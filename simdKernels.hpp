@@ -0,0 +1,415 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define MATRIX_SIMD_X86 0
+#endif
+
+namespace simd {
+    /* double precision kernels used by the Matrix hot loops
+     every kernel has a scalar reference version and, on x86, SSE2, AVX2
+     and AVX-512 versions compiled with target attributes so one binary
+     carries all of them; the best one supported by the running CPU is
+     picked once (CPUID via __builtin_cpu_supports) the first time the
+     kernel table is requested */
+
+    enum class Level { Scalar, SSE2, AVX2, AVX512 };
+
+    // register tile of the GEMM micro-kernel, shared with gemm.hpp
+    constexpr int GEMM_MR = 4;
+    constexpr int GEMM_NR = 8;
+
+    struct Kernels {
+        // y += a * x
+        void (*axpy)(int n, double a, const double *x, double *y);
+        // x *= a
+        void (*scale)(int n, double a, double *x);
+        // sum x[i] * y[i]
+        double (*dot)(int n, const double *x, const double *y);
+        // y += A * x, A is m x n row-major with leading dimension lda
+        void (*gemv)(int m, int n, const double *A, int lda, const double *x, double *y);
+        // y += A^T * x, A is m x n, x has m entries, y has n entries
+        void (*gemvTranspose)(int m, int n, const double *A, int lda, const double *x, double *y);
+        // C(mr x nr) += packed a(kc x MR) * packed b(kc x NR)
+        void (*microKernel)(int kc, const double *a, const double *b, double *C, int ldc, int mr, int nr);
+        Level level;
+    };
+
+    // SCALAR REFERENCE
+    namespace scalar {
+        inline void axpy(int n, double a, const double *x, double *y) {
+            for (int i = 0; i < n; i++)
+                y[i] += a * x[i];
+        }
+
+        inline void scale(int n, double a, double *x) {
+            for (int i = 0; i < n; i++)
+                x[i] *= a;
+        }
+
+        inline double dot(int n, const double *x, const double *y) {
+            double sum = 0.0;
+            for (int i = 0; i < n; i++)
+                sum += x[i] * y[i];
+            return sum;
+        }
+
+        inline void gemv(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                y[i] += dot(n, A + static_cast<long>(i) * lda, x);
+        }
+
+        inline void gemvTranspose(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                axpy(n, x[i], A + static_cast<long>(i) * lda, y);
+        }
+
+        inline void microKernel(int kc, const double *a, const double *b, double *C, int ldc, int mr, int nr) {
+            double acc[GEMM_MR][GEMM_NR] = {};
+            for (int p = 0; p < kc; p++) {
+                for (int r = 0; r < GEMM_MR; r++)
+                    for (int c = 0; c < GEMM_NR; c++)
+                        acc[r][c] += a[r] * b[c];
+                a += GEMM_MR;
+                b += GEMM_NR;
+            }
+            for (int r = 0; r < mr; r++)
+                for (int c = 0; c < nr; c++)
+                    C[static_cast<long>(r) * ldc + c] += acc[r][c];
+        }
+    }
+
+#if MATRIX_SIMD_X86
+    // writes a full register tile back to C, only the valid mr x nr part
+    inline void storeTile(const double (&tile)[GEMM_MR][GEMM_NR], double *C, int ldc, int mr, int nr) {
+        for (int r = 0; r < mr; r++)
+            for (int c = 0; c < nr; c++)
+                C[static_cast<long>(r) * ldc + c] += tile[r][c];
+    }
+
+    // SSE2: 2 doubles per register
+    namespace sse2 {
+        __attribute__((target("sse2")))
+        inline void axpy(int n, double a, const double *x, double *y) {
+            const __m128d va = _mm_set1_pd(a);
+            int i = 0;
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+            for (; i < n; i++)
+                y[i] += a * x[i];
+        }
+
+        __attribute__((target("sse2")))
+        inline void scale(int n, double a, double *x) {
+            const __m128d va = _mm_set1_pd(a);
+            int i = 0;
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(x + i, _mm_mul_pd(va, _mm_loadu_pd(x + i)));
+            for (; i < n; i++)
+                x[i] *= a;
+        }
+
+        __attribute__((target("sse2")))
+        inline double dot(int n, const double *x, const double *y) {
+            __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+            int i = 0;
+            for (; i + 4 <= n; i += 4) {
+                acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+                acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+            }
+            double lanes[2];
+            _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+            double sum = lanes[0] + lanes[1];
+            for (; i < n; i++)
+                sum += x[i] * y[i];
+            return sum;
+        }
+
+        __attribute__((target("sse2")))
+        inline void gemv(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                y[i] += dot(n, A + static_cast<long>(i) * lda, x);
+        }
+
+        __attribute__((target("sse2")))
+        inline void gemvTranspose(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                axpy(n, x[i], A + static_cast<long>(i) * lda, y);
+        }
+
+        __attribute__((target("sse2")))
+        inline void microKernel(int kc, const double *a, const double *b, double *C, int ldc, int mr, int nr) {
+            // 4 rows x 4 registers of 2 = 16 accumulators
+            __m128d acc[GEMM_MR][4];
+            for (int r = 0; r < GEMM_MR; r++)
+                for (int c = 0; c < 4; c++)
+                    acc[r][c] = _mm_setzero_pd();
+
+            for (int p = 0; p < kc; p++) {
+                const __m128d b0 = _mm_loadu_pd(b), b1 = _mm_loadu_pd(b + 2);
+                const __m128d b2 = _mm_loadu_pd(b + 4), b3 = _mm_loadu_pd(b + 6);
+                for (int r = 0; r < GEMM_MR; r++) {
+                    const __m128d ar = _mm_set1_pd(a[r]);
+                    acc[r][0] = _mm_add_pd(acc[r][0], _mm_mul_pd(ar, b0));
+                    acc[r][1] = _mm_add_pd(acc[r][1], _mm_mul_pd(ar, b1));
+                    acc[r][2] = _mm_add_pd(acc[r][2], _mm_mul_pd(ar, b2));
+                    acc[r][3] = _mm_add_pd(acc[r][3], _mm_mul_pd(ar, b3));
+                }
+                a += GEMM_MR;
+                b += GEMM_NR;
+            }
+
+            double tile[GEMM_MR][GEMM_NR];
+            for (int r = 0; r < GEMM_MR; r++)
+                for (int c = 0; c < 4; c++)
+                    _mm_storeu_pd(&tile[r][2 * c], acc[r][c]);
+            storeTile(tile, C, ldc, mr, nr);
+        }
+    }
+
+    // AVX2 + FMA: 4 doubles per register
+    namespace avx2 {
+        __attribute__((target("avx2,fma")))
+        inline void axpy(int n, double a, const double *x, double *y) {
+            const __m256d va = _mm256_set1_pd(a);
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            for (; i < n; i++)
+                y[i] += a * x[i];
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline void scale(int n, double a, double *x) {
+            const __m256d va = _mm256_set1_pd(a);
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(x + i, _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+            for (; i < n; i++)
+                x[i] *= a;
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline double dot(int n, const double *x, const double *y) {
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 8 <= n; i += 8) {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+                acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), acc1);
+            }
+            double lanes[4];
+            _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+            double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            for (; i < n; i++)
+                sum += x[i] * y[i];
+            return sum;
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline void gemv(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                y[i] += dot(n, A + static_cast<long>(i) * lda, x);
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline void gemvTranspose(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                axpy(n, x[i], A + static_cast<long>(i) * lda, y);
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline void microKernel(int kc, const double *a, const double *b, double *C, int ldc, int mr, int nr) {
+            // 4 rows x 2 registers of 4 = 8 accumulators
+            __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+            __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+            __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+            __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+
+            for (int p = 0; p < kc; p++) {
+                const __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+                __m256d ar = _mm256_broadcast_sd(a);
+                c00 = _mm256_fmadd_pd(ar, b0, c00); c01 = _mm256_fmadd_pd(ar, b1, c01);
+                ar = _mm256_broadcast_sd(a + 1);
+                c10 = _mm256_fmadd_pd(ar, b0, c10); c11 = _mm256_fmadd_pd(ar, b1, c11);
+                ar = _mm256_broadcast_sd(a + 2);
+                c20 = _mm256_fmadd_pd(ar, b0, c20); c21 = _mm256_fmadd_pd(ar, b1, c21);
+                ar = _mm256_broadcast_sd(a + 3);
+                c30 = _mm256_fmadd_pd(ar, b0, c30); c31 = _mm256_fmadd_pd(ar, b1, c31);
+                a += GEMM_MR;
+                b += GEMM_NR;
+            }
+
+            if (mr == GEMM_MR && nr == GEMM_NR) {
+                double *c0 = C, *c1 = C + ldc, *c2 = C + 2L * ldc, *c3 = C + 3L * ldc;
+                _mm256_storeu_pd(c0, _mm256_add_pd(_mm256_loadu_pd(c0), c00));
+                _mm256_storeu_pd(c0 + 4, _mm256_add_pd(_mm256_loadu_pd(c0 + 4), c01));
+                _mm256_storeu_pd(c1, _mm256_add_pd(_mm256_loadu_pd(c1), c10));
+                _mm256_storeu_pd(c1 + 4, _mm256_add_pd(_mm256_loadu_pd(c1 + 4), c11));
+                _mm256_storeu_pd(c2, _mm256_add_pd(_mm256_loadu_pd(c2), c20));
+                _mm256_storeu_pd(c2 + 4, _mm256_add_pd(_mm256_loadu_pd(c2 + 4), c21));
+                _mm256_storeu_pd(c3, _mm256_add_pd(_mm256_loadu_pd(c3), c30));
+                _mm256_storeu_pd(c3 + 4, _mm256_add_pd(_mm256_loadu_pd(c3 + 4), c31));
+                return;
+            }
+
+            double tile[GEMM_MR][GEMM_NR];
+            _mm256_storeu_pd(&tile[0][0], c00); _mm256_storeu_pd(&tile[0][4], c01);
+            _mm256_storeu_pd(&tile[1][0], c10); _mm256_storeu_pd(&tile[1][4], c11);
+            _mm256_storeu_pd(&tile[2][0], c20); _mm256_storeu_pd(&tile[2][4], c21);
+            _mm256_storeu_pd(&tile[3][0], c30); _mm256_storeu_pd(&tile[3][4], c31);
+            storeTile(tile, C, ldc, mr, nr);
+        }
+    }
+
+    // AVX-512F: 8 doubles per register, tails handled with lane masks
+    namespace avx512 {
+        __attribute__((target("avx512f")))
+        inline void axpy(int n, double a, const double *x, double *y) {
+            const __m512d va = _mm512_set1_pd(a);
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+                _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+            if (i < n) {
+                const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1);
+                const __m512d vy = _mm512_maskz_loadu_pd(mask, y + i);
+                _mm512_mask_storeu_pd(y + i, mask, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(mask, x + i), vy));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        inline void scale(int n, double a, double *x) {
+            const __m512d va = _mm512_set1_pd(a);
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+                _mm512_storeu_pd(x + i, _mm512_mul_pd(va, _mm512_loadu_pd(x + i)));
+            if (i < n) {
+                const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1);
+                _mm512_mask_storeu_pd(x + i, mask, _mm512_mul_pd(va, _mm512_maskz_loadu_pd(mask, x + i)));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        inline double dot(int n, const double *x, const double *y) {
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+                acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), acc1);
+            }
+            for (; i + 8 <= n; i += 8)
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+            if (i < n) {
+                const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1);
+                acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), acc1);
+            }
+            double lanes[8];
+            _mm512_storeu_pd(lanes, _mm512_add_pd(acc0, acc1));
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        }
+
+        __attribute__((target("avx512f")))
+        inline void gemv(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                y[i] += dot(n, A + static_cast<long>(i) * lda, x);
+        }
+
+        __attribute__((target("avx512f")))
+        inline void gemvTranspose(int m, int n, const double *A, int lda, const double *x, double *y) {
+            for (int i = 0; i < m; i++)
+                axpy(n, x[i], A + static_cast<long>(i) * lda, y);
+        }
+
+        __attribute__((target("avx512f")))
+        inline void microKernel(int kc, const double *a, const double *b, double *C, int ldc, int mr, int nr) {
+            // one register per row of the tile
+            __m512d c0 = _mm512_setzero_pd(), c1 = _mm512_setzero_pd();
+            __m512d c2 = _mm512_setzero_pd(), c3 = _mm512_setzero_pd();
+
+            for (int p = 0; p < kc; p++) {
+                const __m512d bv = _mm512_loadu_pd(b);
+                c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[0]), bv, c0);
+                c1 = _mm512_fmadd_pd(_mm512_set1_pd(a[1]), bv, c1);
+                c2 = _mm512_fmadd_pd(_mm512_set1_pd(a[2]), bv, c2);
+                c3 = _mm512_fmadd_pd(_mm512_set1_pd(a[3]), bv, c3);
+                a += GEMM_MR;
+                b += GEMM_NR;
+            }
+
+            const __mmask8 mask = static_cast<__mmask8>((1u << nr) - 1);
+            const __m512d acc[GEMM_MR] = {c0, c1, c2, c3};
+            for (int r = 0; r < mr; r++) {
+                double *cRow = C + static_cast<long>(r) * ldc;
+                _mm512_mask_storeu_pd(cRow, mask, _mm512_add_pd(_mm512_maskz_loadu_pd(mask, cRow), acc[r]));
+            }
+        }
+    }
+#endif
+
+    inline Kernels kernelsFor(Level level) {
+#if MATRIX_SIMD_X86
+        if (level == Level::AVX512)
+            return {avx512::axpy, avx512::scale, avx512::dot, avx512::gemv,
+                avx512::gemvTranspose, avx512::microKernel, Level::AVX512};
+        if (level == Level::AVX2)
+            return {avx2::axpy, avx2::scale, avx2::dot, avx2::gemv,
+                avx2::gemvTranspose, avx2::microKernel, Level::AVX2};
+        if (level == Level::SSE2)
+            return {sse2::axpy, sse2::scale, sse2::dot, sse2::gemv,
+                sse2::gemvTranspose, sse2::microKernel, Level::SSE2};
+#endif
+        return {scalar::axpy, scalar::scale, scalar::dot, scalar::gemv,
+            scalar::gemvTranspose, scalar::microKernel, Level::Scalar};
+    }
+
+    // highest level the running CPU supports
+    inline Level detectLevel() {
+#if MATRIX_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return Level::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return Level::AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return Level::SSE2;
+#endif
+        return Level::Scalar;
+    }
+
+    // one immutable table per level, so a thread that already holds a
+    // table keeps a consistent set of kernels while the level changes
+    inline const Kernels& tableFor(Level level) {
+        static const Kernels tables[] = {kernelsFor(Level::Scalar), kernelsFor(Level::SSE2),
+            kernelsFor(Level::AVX2), kernelsFor(Level::AVX512)};
+        return tables[static_cast<int>(level)];
+    }
+
+    // the selected table, detected once on first use; only the pointer
+    // is ever swapped, atomically
+    inline std::atomic<const Kernels*>& selection() {
+        static std::atomic<const Kernels*> current(&tableFor(detectLevel()));
+        return current;
+    }
+
+    inline const Kernels& active() {
+        return *selection().load(std::memory_order_acquire);
+    }
+
+    // forces a level (e.g. Level::Scalar to verify against the reference),
+    // levels the CPU doesn't support are clamped to the detected one
+    inline void setLevel(Level level) {
+        selection().store(&tableFor(std::min(level, detectLevel())), std::memory_order_release);
+    }
+
+    inline const char* levelName(Level level) {
+        switch (level) {
+            case Level::AVX512: return "AVX-512";
+            case Level::AVX2: return "AVX2";
+            case Level::SSE2: return "SSE2";
+            default: return "scalar";
+        }
+    }
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <utility>
+#include "matrix.hpp"
+
+template <class T>
+class SparseMatrix {
+    /* compressed sparse row (CSR) storage:
+     the non-zeros of row i are values[rowStart[i] .. rowStart[i+1])
+     with their column indices in colIndex, sorted ascending.
+     memory and a matrix-vector product are O(rows + nnz) */
+    int rows, cols;
+    std::vector<int> rowStart;
+    std::vector<int> colIndex;
+    std::vector<T> values;
+
+    public:
+    // non-owning view over the entries of one row, columns are reported
+    // relative to offset (the first column of a block)
+    struct Row {
+        const int *cols;
+        const T *vals;
+        int count;
+        int offset = 0;
+
+        int size() const { return count; }
+        int col(int k) const { return cols[k] - offset; }
+        T value(int k) const { return vals[k]; }
+    };
+
+    // non-owning view of rows [row0, row0 + r) and columns [col0, col0 + c),
+    // e.g. Q or R of a transition matrix without copying the CSR arrays.
+    // It refers to the matrix object, so it stays valid when the matrix
+    // is refilled but must not outlive it
+    class Block {
+        const SparseMatrix<T> *m;
+        int row0, col0, r, c;
+
+        public:
+        Block(const SparseMatrix<T>& matrix, int row, int col, int numRows, int numCols)
+            : m(&matrix), row0(row), col0(col), r(numRows), c(numCols) {
+            if (row < 0 || col < 0 || numRows < 0 || numCols < 0
+                || row + numRows > matrix.getRows() || col + numCols > matrix.getCols())
+                throw std::out_of_range("Block must lie inside the matrix.");
+        }
+
+        // entries of row i inside the column range, found by binary search
+        Row row(int i) const {
+            const Row full = m->row(row0 + i);
+            const int *first = std::lower_bound(full.cols, full.cols + full.count, col0);
+            const int *last = std::lower_bound(first, full.cols + full.count, col0 + c);
+            const int begin = static_cast<int>(first - full.cols);
+            return Row{first, full.vals + begin, static_cast<int>(last - first), col0};
+        }
+
+        T at(int i, int j) const {
+            if (i < 0 || i >= r || j < 0 || j >= c)
+                throw std::out_of_range("Index out of range in block.");
+            return m->at(row0 + i, col0 + j);
+        }
+
+        // y = B x
+        void multiply(const T *x, T *y) const {
+            for (int i = 0; i < r; i++) {
+                const Row entries = row(i);
+                T sum = T(0);
+                for (int k = 0; k < entries.size(); k++)
+                    sum += entries.value(k) * x[entries.col(k)];
+                y[i] = sum;
+            }
+        }
+
+        // y = B^T x
+        void multiplyTranspose(const T *x, T *y) const {
+            std::fill(y, y + c, T(0));
+            for (int i = 0; i < r; i++) {
+                if (x[i] == T(0))
+                    continue;
+                const Row entries = row(i);
+                for (int k = 0; k < entries.size(); k++)
+                    y[entries.col(k)] += entries.value(k) * x[i];
+            }
+        }
+
+        Matrix<T> toDense() const {
+            Matrix<T> dense(r, c, T(0));
+            for (int i = 0; i < r; i++) {
+                const Row entries = row(i);
+                T *out = dense[i];
+                for (int k = 0; k < entries.size(); k++)
+                    out[entries.col(k)] = entries.value(k);
+            }
+            return dense;
+        }
+
+        int getRows() const { return r; }
+        int getCols() const { return c; }
+    };
+
+    SparseMatrix() : rows(0), cols(0), rowStart(1, 0) {}
+
+    // empty matrix, rows are then filled in order with appendRow
+    SparseMatrix(int r, int c) : rows(0), cols(c), rowStart(1, 0) {
+        rowStart.reserve(r + 1);
+    }
+
+    // appends the next row, entries may be unsorted and contain
+    // repeated columns (they are summed), exact zeros are dropped
+    void appendRow(std::vector<std::pair<int, T>> entries) {
+        std::sort(entries.begin(), entries.end(),
+            [](const std::pair<int, T>& a, const std::pair<int, T>& b) { return a.first < b.first; });
+
+        for (size_t k = 0; k < entries.size(); k++) {
+            const int col = entries[k].first;
+            if (col < 0 || col >= cols)
+                throw std::out_of_range("Column index out of range in appendRow.");
+
+            T sum = entries[k].second;
+            while (k + 1 < entries.size() && entries[k + 1].first == col)
+                sum += entries[++k].second;
+
+            if (sum != T(0)) {
+                colIndex.push_back(col);
+                values.push_back(sum);
+            }
+        }
+        rowStart.push_back(static_cast<int>(values.size()));
+        rows++;
+    }
+
+    static SparseMatrix<T> fromDense(const Matrix<T>& dense, T dropTolerance = T(0)) {
+        SparseMatrix<T> sparse(dense.getRows(), dense.getCols());
+        std::vector<std::pair<int, T>> entries;
+        for (int i = 0; i < dense.getRows(); i++) {
+            entries.clear();
+            const T *row = dense[i];
+            for (int j = 0; j < dense.getCols(); j++) {
+                if (std::abs(row[j]) > dropTolerance)
+                    entries.emplace_back(j, row[j]);
+            }
+            sparse.appendRow(entries);
+        }
+        return sparse;
+    }
+
+    Matrix<T> toDense() const {
+        Matrix<T> dense(rows, cols, T(0));
+        for (int i = 0; i < rows; i++) {
+            T *out = dense[i];
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+                out[colIndex[k]] = values[k];
+        }
+        return dense;
+    }
+
+    Block block(int row, int col, int numRows, int numCols) const {
+        return Block(*this, row, col, numRows, numCols);
+    }
+
+    // top-left r x c block copied into a new matrix, e.g. the transient part Q of a transition matrix
+    SparseMatrix<T> leadingBlock(int r, int c) const {
+        if (r > rows || c > cols)
+            throw std::out_of_range("Block is larger than the matrix.");
+
+        SparseMatrix<T> block(r, c);
+        for (int i = 0; i < r; i++) {
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++) {
+                if (colIndex[k] < c) {
+                    block.colIndex.push_back(colIndex[k]);
+                    block.values.push_back(values[k]);
+                }
+            }
+            block.rowStart.push_back(static_cast<int>(block.values.size()));
+            block.rows++;
+        }
+        return block;
+    }
+
+    SparseMatrix<T> transpose() const {
+        SparseMatrix<T> t;
+        t.rows = cols;
+        t.cols = rows;
+        t.rowStart.assign(cols + 1, 0);
+        t.colIndex.resize(values.size());
+        t.values.resize(values.size());
+
+        // counting sort by column keeps the new rows sorted
+        for (int c : colIndex)
+            t.rowStart[c + 1]++;
+        for (int c = 0; c < cols; c++)
+            t.rowStart[c + 1] += t.rowStart[c];
+
+        std::vector<int> next(t.rowStart.begin(), t.rowStart.end() - 1);
+        for (int i = 0; i < rows; i++) {
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++) {
+                const int dest = next[colIndex[k]]++;
+                t.colIndex[dest] = i;
+                t.values[dest] = values[k];
+            }
+        }
+        return t;
+    }
+
+    // y = A x
+    void multiply(const T *x, T *y) const {
+        for (int i = 0; i < rows; i++) {
+            T sum = T(0);
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+                sum += values[k] * x[colIndex[k]];
+            y[i] = sum;
+        }
+    }
+
+    // y = A^T x (x has rows entries, y has cols entries), scatters row by
+    // row so no transposed copy is needed
+    void multiplyTranspose(const T *x, T *y) const {
+        std::fill(y, y + cols, T(0));
+        for (int i = 0; i < rows; i++) {
+            const T xi = x[i];
+            if (xi == T(0))
+                continue;
+            for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+                y[colIndex[k]] += values[k] * xi;
+        }
+    }
+
+    std::vector<T> operator * (const std::vector<T>& x) const {
+        if (static_cast<int>(x.size()) != cols)
+            throw std::invalid_argument("Vector length must match the columns of the matrix.");
+        std::vector<T> y(rows);
+        multiply(x.data(), y.data());
+        return y;
+    }
+
+    std::vector<T> multiplyTranspose(const std::vector<T>& x) const {
+        if (static_cast<int>(x.size()) != rows)
+            throw std::invalid_argument("Vector length must match the rows of the matrix.");
+        std::vector<T> y(cols);
+        multiplyTranspose(x.data(), y.data());
+        return y;
+    }
+
+    Row row(int i) const {
+        const int begin = rowStart[i];
+        return Row{colIndex.data() + begin, values.data() + begin, rowStart[i + 1] - begin};
+    }
+
+    // value of entry (i, j), zero if not stored
+    T at(int i, int j) const {
+        auto first = colIndex.begin() + rowStart[i];
+        auto last = colIndex.begin() + rowStart[i + 1];
+        auto it = std::lower_bound(first, last, j);
+        if (it == last || *it != j)
+            return T(0);
+        return values[it - colIndex.begin()];
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int nonZeros() const { return static_cast<int>(values.size()); }
+
+    const std::vector<int>& getRowStart() const { return rowStart; }
+    const std::vector<int>& getColIndex() const { return colIndex; }
+    const std::vector<T>& getValues() const { return values; }
+};
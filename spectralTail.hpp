@@ -0,0 +1,406 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "matrix.hpp"
+#include "sparseMatrix.hpp"
+#include "transitionMatrix.hpp"
+#include "iterativeSolvers.hpp"
+
+namespace spectral {
+    // eigenvalues of an upper Hessenberg matrix (destroyed) by the
+    // Francis double-shift QR algorithm (EISPACK hqr)
+    inline std::vector<std::complex<double>> hessenbergEigenvalues(Matrix<double> a) {
+        const int n = a.getRows();
+        std::vector<double> wr(n, 0.0), wi(n, 0.0);
+        double anorm = 0.0;
+        for (int i = 0; i < n; i++)
+            for (int j = std::max(i - 1, 0); j < n; j++)
+                anorm += std::abs(a[i][j]);
+
+        auto sign = [](double magnitude, double s) { return s >= 0.0 ? std::abs(magnitude) : -std::abs(magnitude); };
+        int nn = n - 1;
+        double t = 0.0;
+        while (nn >= 0) {
+            int its = 0, l;
+            do {
+                // look for a single small subdiagonal element
+                for (l = nn; l >= 1; l--) {
+                    double s = std::abs(a[l - 1][l - 1]) + std::abs(a[l][l]);
+                    if (s == 0.0)
+                        s = anorm;
+                    if (std::abs(a[l][l - 1]) + s == s) {
+                        a[l][l - 1] = 0.0;
+                        break;
+                    }
+                }
+                double x = a[nn][nn];
+                if (l == nn) {
+                    // one root found
+                    wr[nn] = x + t;
+                    wi[nn--] = 0.0;
+                } else {
+                    double y = a[nn - 1][nn - 1];
+                    double w = a[nn][nn - 1] * a[nn - 1][nn];
+                    if (l == nn - 1) {
+                        // two roots found
+                        const double p = 0.5 * (y - x);
+                        const double q = p * p + w;
+                        double z = std::sqrt(std::abs(q));
+                        x += t;
+                        if (q >= 0.0) {
+                            z = p + sign(z, p);
+                            wr[nn - 1] = wr[nn] = x + z;
+                            if (z != 0.0)
+                                wr[nn] = x - w / z;
+                            wi[nn - 1] = wi[nn] = 0.0;
+                        } else {
+                            wr[nn - 1] = wr[nn] = x + p;
+                            wi[nn - 1] = -(wi[nn] = z);
+                        }
+                        nn -= 2;
+                    } else {
+                        if (its == 60)
+                            throw std::runtime_error("Hessenberg QR did not converge.");
+                        if (its == 10 || its == 20) {
+                            // exceptional shift
+                            t += x;
+                            for (int i = 0; i <= nn; i++)
+                                a[i][i] -= x;
+                            const double s = std::abs(a[nn][nn - 1]) + std::abs(a[nn - 1][nn - 2]);
+                            y = x = 0.75 * s;
+                            w = -0.4375 * s * s;
+                        }
+                        ++its;
+
+                        // look for two consecutive small subdiagonal elements
+                        int m;
+                        double p = 0.0, q = 0.0, r = 0.0, z;
+                        for (m = nn - 2; m >= l; m--) {
+                            z = a[m][m];
+                            r = x - z;
+                            double s = y - z;
+                            p = (r * s - w) / a[m + 1][m] + a[m][m + 1];
+                            q = a[m + 1][m + 1] - z - r - s;
+                            r = a[m + 2][m + 1];
+                            s = std::abs(p) + std::abs(q) + std::abs(r);
+                            p /= s;
+                            q /= s;
+                            r /= s;
+                            if (m == l)
+                                break;
+                            const double u = std::abs(a[m][m - 1]) * (std::abs(q) + std::abs(r));
+                            const double v = std::abs(p) * (std::abs(a[m - 1][m - 1]) + std::abs(z) + std::abs(a[m + 1][m + 1]));
+                            if (u + v == v)
+                                break;
+                        }
+                        for (int i = m + 2; i <= nn; i++) {
+                            a[i][i - 2] = 0.0;
+                            if (i != m + 2)
+                                a[i][i - 3] = 0.0;
+                        }
+
+                        // double QR step on rows l .. nn, columns m .. nn
+                        for (int k = m; k <= nn - 1; k++) {
+                            if (k != m) {
+                                p = a[k][k - 1];
+                                q = a[k + 1][k - 1];
+                                r = 0.0;
+                                if (k != nn - 1)
+                                    r = a[k + 2][k - 1];
+                                if ((x = std::abs(p) + std::abs(q) + std::abs(r)) != 0.0) {
+                                    p /= x;
+                                    q /= x;
+                                    r /= x;
+                                }
+                            }
+                            const double s = sign(std::sqrt(p * p + q * q + r * r), p);
+                            if (s == 0.0)
+                                continue;
+                            if (k == m) {
+                                if (l != m)
+                                    a[k][k - 1] = -a[k][k - 1];
+                            } else {
+                                a[k][k - 1] = -s * x;
+                            }
+                            p += s;
+                            x = p / s;
+                            y = q / s;
+                            z = r / s;
+                            q /= p;
+                            r /= p;
+                            for (int j = k; j <= nn; j++) {
+                                p = a[k][j] + q * a[k + 1][j];
+                                if (k != nn - 1) {
+                                    p += r * a[k + 2][j];
+                                    a[k + 2][j] -= p * z;
+                                }
+                                a[k + 1][j] -= p * y;
+                                a[k][j] -= p * x;
+                            }
+                            const int last = std::min(nn, k + 3);
+                            for (int i = l; i <= last; i++) {
+                                p = x * a[i][k] + y * a[i][k + 1];
+                                if (k != nn - 1) {
+                                    p += z * a[i][k + 2];
+                                    a[i][k + 2] -= p * r;
+                                }
+                                a[i][k + 1] -= p * q;
+                                a[i][k] -= p;
+                            }
+                        }
+                    }
+                }
+            } while (l < nn - 1);
+        }
+
+        std::vector<std::complex<double>> eigenvalues(n);
+        for (int i = 0; i < n; i++)
+            eigenvalues[i] = std::complex<double>(wr[i], wi[i]);
+        return eigenvalues;
+    }
+
+    // Ritz values of A from an m-step Arnoldi process started at x0,
+    // largest modulus first; the outermost ones converge first
+    inline std::vector<std::complex<double>> arnoldiEigenvalues(const SparseMatrix<double>& A,
+        std::vector<double> x0, int krylovDimension) {
+        const int n = A.getRows();
+        const int m = std::min(n, krylovDimension);
+        Matrix<double> H(m, m, 0.0);
+        std::vector<std::vector<double>> V;
+        V.reserve(m);
+
+        const double norm0 = iterative::norm(x0);
+        if (norm0 == 0.0)
+            throw std::invalid_argument("Arnoldi needs a non-zero start vector.");
+        for (double& v : x0)
+            v /= norm0;
+        V.push_back(std::move(x0));
+
+        int size = m;
+        std::vector<double> w(n);
+        for (int j = 0; j < m; j++) {
+            A.multiply(V[j].data(), w.data());
+            // modified Gram-Schmidt, twice for stability
+            for (int pass = 0; pass < 2; pass++) {
+                for (int i = 0; i <= j; i++) {
+                    const double h = iterative::dot(V[i], w);
+                    H[i][j] += h;
+                    simd::active().axpy(n, -h, V[i].data(), w.data());
+                }
+            }
+            if (j + 1 == m)
+                break;
+            const double h = iterative::norm(w);
+            if (h < 1e-14) {
+                // invariant subspace: its eigenvalues are exact
+                size = j + 1;
+                break;
+            }
+            H[j + 1][j] = h;
+            V.emplace_back(w);
+            for (double& v : V.back())
+                v /= h;
+        }
+
+        std::vector<std::complex<double>> ritz = hessenbergEigenvalues(Matrix<double>(H.block(0, 0, size, size)));
+        std::sort(ritz.begin(), ritz.end(), [](const std::complex<double>& a, const std::complex<double>& b) {
+            return std::abs(a) > std::abs(b);
+        });
+        return ritz;
+    }
+}
+
+class SpectralTailModel {
+    /* long-tail model of the game length T from one start block.
+     For large k, P(T > k) = e_start Q^k 1 is dominated by the Perron
+     root lambda of the transient block Q (real, positive, with a
+     non-negative eigenvector) and the next eigenvalue modulus rho:
+        P(T > k) = c lambda^k + O(rho^k)
+     The model steps the exact distribution once, until one more step
+     multiplies the survival by lambda to within the anchor tolerance
+     (turn K), and from there answers
+        P(T > k) = P(T > K) lambda^(k - K)
+     in O(1) for any k. With the one-step deviation
+     delta = |S(K) - lambda S(K - 1)| / S(K), the first-order relative
+     error of every extrapolated value is at most
+        2 delta rho / (lambda - rho)
+     lambda comes from power iteration on Q (its left eigenvector from
+     Q^T gives the asymptotic constant c), rho and further eigenvalues
+     from an Arnoldi process on Q */
+    int start;
+    double lambda;
+    double rho;
+    double asymptoticConstant;
+    std::vector<double> rightVector, leftVector;
+    std::vector<std::complex<double>> spectrum;   // leading eigenvalues, largest modulus first
+    std::vector<double> exactSurvival;            // P(T > k), k = 0 .. anchor
+    double deviation;
+
+    // dominant eigenpair by power iteration, returns lambda
+    static double powerIteration(const SparseMatrix<double>& A, std::vector<double>& v, bool transpose,
+        double tolerance, int maxIterations) {
+        const int n = A.getRows();
+        std::vector<double> w(n);
+        double estimate = 0.0;
+        for (int it = 0; it < maxIterations; it++) {
+            if (transpose)
+                A.multiplyTranspose(v.data(), w.data());
+            else
+                A.multiply(v.data(), w.data());
+            const double norm = iterative::norm(w);
+            if (norm == 0.0)
+                return 0.0;
+            // ||Av - lambda v|| with v of unit length
+            double residual = 0.0;
+            for (int i = 0; i < n; i++) {
+                const double d = w[i] - norm * v[i];
+                residual += d * d;
+            }
+            for (int i = 0; i < n; i++)
+                v[i] = w[i] / norm;
+            estimate = norm;
+            if (std::sqrt(residual) <= tolerance * norm)
+                return estimate;
+        }
+        throw std::runtime_error("Power iteration did not converge, the dominant eigenvalue may not be unique.");
+    }
+
+    public:
+    explicit SpectralTailModel(const TransitionMatrix& chain, int startBlock = 0, int eigenvalueCount = 4,
+        double anchorTolerance = 1e-10, double tolerance = 1e-13, int maxIterations = 1000000)
+        : start(startBlock), deviation(0.0) {
+        const SparseMatrix<double> Q = chain.getSparseQMatrix();
+        const int n = Q.getRows();
+        if (n <= 0)
+            throw std::invalid_argument("Transition matrix has no transient blocks, calculate the probabilities first.");
+        if (start < 0 || start >= n)
+            throw std::out_of_range("Start block must be a transient state.");
+
+        // one-time spectral cost
+        const double unit = 1.0 / std::sqrt(static_cast<double>(n));
+        rightVector.assign(n, unit);
+        leftVector.assign(n, unit);
+        lambda = powerIteration(Q, rightVector, false, tolerance, maxIterations);
+        powerIteration(Q, leftVector, true, tolerance, maxIterations);
+
+        // c = (e_start . v)(u . 1) / (u . v)
+        double u1 = 0.0, uv = 0.0;
+        for (int i = 0; i < n; i++) {
+            u1 += leftVector[i];
+            uv += leftVector[i] * rightVector[i];
+        }
+        asymptoticConstant = uv != 0.0 ? rightVector[start] * u1 / uv : 0.0;
+
+        std::vector<double> x0(n);
+        for (int i = 0; i < n; i++)
+            x0[i] = 1.0 + 0.5 * std::sin(1.0 + i); // generic, not orthogonal to any eigenvector
+        spectrum = spectral::arnoldiEigenvalues(Q, x0, std::max(30, 3 * eigenvalueCount));
+        if (static_cast<int>(spectrum.size()) > eigenvalueCount)
+            spectrum.resize(std::max(eigenvalueCount, 2));
+        rho = spectrum.size() > 1 ? std::abs(spectrum[1]) : 0.0;
+
+        // exact stepping to the anchor turn
+        std::vector<double> pi(n, 0.0), next(n);
+        pi[start] = 1.0;
+        exactSurvival.push_back(1.0);
+        for (int k = 1; k <= maxIterations; k++) {
+            Q.multiplyTranspose(pi.data(), next.data());
+            pi.swap(next);
+            double survival = 0.0;
+            for (int i = 0; i < n; i++)
+                survival += pi[i];
+            exactSurvival.push_back(survival);
+            if (survival <= 0.0)
+                return;
+            deviation = std::abs(survival - lambda * exactSurvival[k - 1]) / survival;
+            if (deviation <= anchorTolerance)
+                return;
+        }
+        throw std::runtime_error("Survival did not reach the geometric regime.");
+    }
+
+    // P(T > k), exact up to the anchor turn, extrapolated beyond it
+    double survival(long long k) const {
+        if (k < 0)
+            throw std::out_of_range("Turn count must not be negative.");
+        const int K = anchor();
+        if (k <= K)
+            return exactSurvival[k];
+        return exactSurvival[K] * std::pow(lambda, static_cast<double>(k - K));
+    }
+
+    // log P(T > k), stays finite where P(T > k) underflows
+    double logSurvival(long long k) const {
+        if (k < 0)
+            throw std::out_of_range("Turn count must not be negative.");
+        const int K = anchor();
+        if (k <= K)
+            return std::log(exactSurvival[k]);
+        return std::log(exactSurvival[K]) + static_cast<double>(k - K) * std::log(lambda);
+    }
+
+    double winProbability(long long k) const {
+        return 1.0 - survival(k);
+    }
+
+    // smallest k with P(T > k) <= p, O(1) in the geometric regime
+    long long turnsUntilSurvivalBelow(double p) const {
+        if (!(p > 0.0 && p < 1.0))
+            throw std::invalid_argument("Survival level must lie in (0, 1).");
+        const int K = anchor();
+        for (int k = 0; k <= K; k++) {
+            if (exactSurvival[k] <= p)
+                return k;
+        }
+        if (lambda <= 0.0)
+            return K + 1;
+        const double steps = std::log(p / exactSurvival[K]) / std::log(lambda);
+        long long k = K + static_cast<long long>(std::ceil(steps));
+        while (k > K + 1 && survival(k - 1) <= p)
+            k--;
+        while (survival(k) > p)
+            k++;
+        return k;
+    }
+
+    // bound on |model - exact| / exact for every k beyond the anchor
+    double relativeErrorBound() const {
+        if (rho >= lambda)
+            return std::numeric_limits<double>::infinity();
+        return 2.0 * deviation * rho / (lambda - rho);
+    }
+
+    // P(T > k) ~ c lambda^k, the constant from the eigenvectors
+    double asymptoticSurvival(long long k) const {
+        return asymptoticConstant * std::pow(lambda, static_cast<double>(k));
+    }
+
+    double dominantEigenvalue() const {
+        return lambda;
+    }
+
+    double subdominantModulus() const {
+        return rho;
+    }
+
+    const std::vector<std::complex<double>>& leadingEigenvalues() const {
+        return spectrum;
+    }
+
+    const std::vector<double>& dominantRightVector() const {
+        return rightVector;
+    }
+
+    const std::vector<double>& dominantLeftVector() const {
+        return leftVector;
+    }
+
+    // last turn that was stepped exactly
+    int anchor() const {
+        return static_cast<int>(exactSurvival.size()) - 1;
+    }
+};
@@ -0,0 +1,50 @@
+#include <cmath>
+#include "check.hpp"
+#include "absorptionTime.hpp"
+#include "canonicalBoards.hpp"
+#include "monteCarloSimulator.hpp"
+
+// the game-length distribution against its own moments, the compile-time
+// win curve and a simulation
+
+int main() {
+    const JumpTable table = boards::toJumpTable<100>(boards::classicJumps);
+    TransitionMatrix chain(table);
+    chain.calculateProbabilities();
+    const AbsorptionTimeDistribution length(chain);
+
+    check::that(!length.isTruncated(), "sweep reaches the tail tolerance");
+    double mass = 0.0, first = 0.0, second = 0.0;
+    for (int k = 0; k <= length.horizon(); k++) {
+        mass += length.pmf(k);
+        first += k * length.pmf(k);
+        second += static_cast<double>(k) * k * length.pmf(k);
+    }
+    check::near(mass, 1.0, 1e-10, "PMF sums to one");
+    check::near(length.mean(), chain.getExpectedMoves()[0][0], 1e-9, "mean equals N 1");
+    check::near(length.mean(), first, 1e-8, "mean equals the first moment of the PMF");
+    check::near(length.variance(), second - first * first, 1e-6, "variance equals the central second moment of the PMF");
+    check::near(length.expectedRemaining(0), length.mean(), 1e-9, "remaining moves from turn 0");
+
+    double worst = 0.0;
+    for (int k = 0; k <= 100; k++)
+        worst = std::max(worst, std::abs(length.cdf(k) - boards::classic.winProbability[k]));
+    check::near(worst, 0.0, 1e-12, "CDF equals the compile-time win curve");
+
+    // simulated games, within 4 standard errors
+    const long long games = 400000;
+    MonteCarloSimulator simulator(table);
+    const SimulationResult simulated = simulator.run(games, 9);
+    const double meanError = length.standardDeviation() / std::sqrt(static_cast<double>(games));
+    check::near(simulated.meanLength, length.mean(), 4.0 * meanError, "simulated mean length");
+    check::near(simulated.varianceLength, length.variance(), 0.02 * length.variance(), "simulated variance");
+    for (int k : {20, 40, 80}) {
+        long long won = 0;
+        for (int t = 0; t <= k && t < static_cast<int>(simulated.lengthHistogram.size()); t++)
+            won += simulated.lengthHistogram[t];
+        const double p = length.cdf(k);
+        const double error = std::sqrt(p * (1.0 - p) / games);
+        check::near(static_cast<double>(won) / games, p, 4.0 * error, "simulated P(T <= " + std::to_string(k) + ")");
+    }
+    return check::result("absorptionTime");
+}
@@ -0,0 +1,42 @@
+#include <vector>
+#include <algorithm>
+#include "check.hpp"
+#include "canonicalBoards.hpp"
+#include "transitionMatrix.hpp"
+
+// the boards analysed at compile time against the runtime chain
+
+static_assert(boards::classic.expectedMoves[0] > 39.8 && boards::classic.expectedMoves[0] < 39.9,
+    "classic board is solved during compilation");
+
+template <std::size_t N, class Analysis>
+void compareWithRuntime(const std::array<boards::Jump, N>& jumps, const Analysis& analysis, const std::string& name) {
+    TransitionMatrix chain(boards::toJumpTable<100>(jumps));
+    chain.calculateProbabilities();
+
+    // expected moves from every transient block
+    const Matrix<double> t = chain.getExpectedMoves();
+    double worst = 0.0;
+    for (int i = 0; i < t.getRows(); i++)
+        worst = std::max(worst, std::abs(t[i][0] - analysis.expectedMoves[i]));
+    check::near(worst, 0.0, 1e-12, name + " expected moves");
+
+    // win probability after k turns by stepping pi(k + 1) = pi(k) P
+    const SparseMatrix<double>& P = chain.getSparseTransitionMatrix();
+    std::vector<double> pi(100, 0.0), next(100);
+    pi[0] = 1.0;
+    worst = 0.0;
+    for (int k = 0; k <= 100; k++) {
+        worst = std::max(worst, std::abs(pi[99] - analysis.winProbability[k]));
+        P.multiplyTranspose(pi.data(), next.data());
+        pi.swap(next);
+    }
+    check::near(worst, 0.0, 1e-12, name + " win probabilities");
+}
+
+int main() {
+    compareWithRuntime(boards::classicJumps, boards::classic, "classic");
+    compareWithRuntime(boards::emptyJumps, boards::empty, "empty");
+    check::near(boards::classic.expectedMoves[0], 39.877621, 1e-6, "classic expected moves from square 1");
+    return check::result("canonicalBoards");
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <iostream>
+#include <cmath>
+#include <string>
+
+// minimal checks for the test programs: a failed check is printed and
+// counted, and main returns check::result() so `make test` stops on it
+namespace check {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void that(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << "\n";
+            failures()++;
+        }
+    }
+
+    // |actual - expected| <= tolerance
+    inline void near(double actual, double expected, double tolerance, const std::string& what) {
+        if (!(std::abs(actual - expected) <= tolerance)) {
+            std::cerr << "FAILED: " << what << ": " << actual << " vs " << expected
+                      << " (tolerance " << tolerance << ")\n";
+            failures()++;
+        }
+    }
+
+    template <class Exception, class Call>
+    void throws(Call call, const std::string& what) {
+        try {
+            call();
+        } catch (const Exception&) {
+            return;
+        }
+        std::cerr << "FAILED: " << what << " did not throw\n";
+        failures()++;
+    }
+
+    inline int result(const std::string& name) {
+        std::cout << name << ": " << (failures() == 0 ? "ok" : std::to_string(failures()) + " failed") << "\n";
+        return failures() == 0 ? 0 : 1;
+    }
+}
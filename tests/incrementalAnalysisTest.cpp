@@ -0,0 +1,71 @@
+#include <random>
+#include <algorithm>
+#include "check.hpp"
+#include "incrementalAnalysis.hpp"
+
+// Sherman-Morrison edits against a full refactorization after every edit
+
+int main() {
+    const int blocks = 200;
+    JumpTable table(blocks);
+    table.setJump(16, 6);
+    table.setJump(3, 40);
+    table.setJump(90, 150);
+    table.setJump(197, 20);
+
+    // no forced refactorization, so the updates themselves are tested
+    IncrementalAnalysis incremental(table, 1000, 1e-9);
+    std::mt19937 gen(5);
+    double worstMoves = 0.0, worstN = 0.0;
+    int edits = 0;
+    for (int e = 0; e < 40; e++) {
+        const int start = 1 + static_cast<int>(gen() % (blocks - 2));
+        const int end = static_cast<int>(gen() % (blocks - 1));
+        try {
+            if (e % 5 == 4)
+                incremental.clearJump(start);
+            else
+                incremental.setJump(start, end);
+        } catch (const std::runtime_error&) {
+            // the edit cut the winning block off, the analysis is unchanged
+            continue;
+        }
+        edits++;
+
+        TransitionMatrix chain(incremental.getJumpTable());
+        chain.calculateProbabilities();
+        const Matrix<double> t = chain.getExpectedMoves();
+        const Matrix<double> N = chain.getFundamentalMatrix();
+        const Matrix<double>& tIncremental = incremental.getExpectedMoves();
+        const Matrix<double>& NIncremental = incremental.getFundamentalMatrix();
+        for (int i = 0; i < blocks - 1; i++) {
+            worstMoves = std::max(worstMoves, std::abs(t[i][0] - tIncremental[i][0]) / t[i][0]);
+            for (int j = 0; j < blocks - 1; j++)
+                worstN = std::max(worstN, std::abs(N[i][j] - NIncremental[i][j]));
+        }
+    }
+    check::that(edits >= 30, "most random edits keep the board winnable");
+    check::near(worstMoves, 0.0, 1e-10, "relative error of the expected moves");
+    check::near(worstN, 0.0, 1e-9, "error of the fundamental matrix");
+    check::near(incremental.residual(), 0.0, 1e-12, "residual of (I - Q) t = 1");
+
+    // moving a jump is a removal and an insertion
+    JumpTable moved = incremental.getJumpTable();
+    int from = 1;
+    while (!moved.hasJump(from) || moved[from] == from)
+        from++;
+    int to = from + 1;
+    while (moved.hasJump(to) && moved[to] != to)
+        to++;
+    const int end = moved[from];
+    incremental.moveJump(from, to);
+    moved.clearJump(from);
+    moved.setJump(to, end);
+    TransitionMatrix chain(moved);
+    chain.calculateProbabilities();
+    check::near(incremental.getExpectedMoves()[0][0], chain.getExpectedMoves()[0][0], 1e-9, "expected moves after moveJump");
+
+    check::throws<std::invalid_argument>([&]() { incremental.moveJump(to, to); }, "moving a jump onto itself");
+    check::throws<std::out_of_range>([&]() { incremental.setJump(blocks, 0); }, "a jump off the board");
+    return check::result("incrementalAnalysis");
+}
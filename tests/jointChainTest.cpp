@@ -0,0 +1,74 @@
+#include <random>
+#include <vector>
+#include <cmath>
+#include "check.hpp"
+#include "jointChain.hpp"
+#include "raceAnalysis.hpp"
+#include "moveRules.hpp"
+#include "canonicalBoards.hpp"
+
+// the joint chain without interaction against RaceAnalysis, and with
+// bumping against a direct simulation of the same rules
+
+// seat wins of games where landing on an occupied block (other than the
+// start and winning blocks) sends its owner back to block 0
+std::vector<double> simulateBumping(const JumpTable& jumps, int players, long long games, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<int> dice(1, 6);
+    const int lastBlock = jumps.size() - 1;
+    std::vector<long long> wins(players, 0);
+    std::vector<int> position(players);
+    for (long long g = 0; g < games; g++) {
+        std::fill(position.begin(), position.end(), 0);
+        int winner = -1;
+        while (winner < 0) {
+            for (int i = 0; i < players && winner < 0; i++) {
+                const int destination = rules::moveDestination(position[i], dice(gen), jumps.size(), jumps);
+                if (destination != position[i] && destination != 0 && destination != lastBlock) {
+                    for (int j = 0; j < players; j++) {
+                        if (j != i && position[j] == destination)
+                            position[j] = 0;
+                    }
+                }
+                position[i] = destination;
+                if (destination == lastBlock)
+                    winner = i;
+            }
+        }
+        wins[winner]++;
+    }
+    std::vector<double> shares(players);
+    for (int i = 0; i < players; i++)
+        shares[i] = static_cast<double>(wins[i]) / games;
+    return shares;
+}
+
+int main() {
+    const JumpTable jumps = boards::toJumpTable<100>(boards::classicJumps);
+    TransitionMatrix chain(jumps);
+    chain.calculateProbabilities();
+
+    for (int players : {2, 3}) {
+        const std::string name = std::to_string(players) + " players";
+        const InteractingRaceAnalysis joint(chain, players, Interaction::None);
+        const RaceAnalysis race(chain, players);
+        for (int i = 0; i < players; i++)
+            check::near(joint.winProbability(i), race.winProbability(i), 1e-8, name + " seat wins without interaction");
+        check::near(joint.getExpectedRounds(), race.getExpectedRounds(), 1e-6, name + " rounds without interaction");
+        check::near(joint.getExpectedMoves(), race.getExpectedMoves(), 1e-6, name + " moves without interaction");
+    }
+
+    const long long games = 400000;
+    const InteractingRaceAnalysis bumping(chain, 2, Interaction::Bump);
+    const std::vector<double> simulated = simulateBumping(jumps, 2, games, 5);
+    check::near(bumping.winProbability(0) + bumping.winProbability(1) + bumping.unresolvedProbability(), 1.0, 1e-9,
+        "bumping seat wins and the unresolved tail sum to one");
+    for (int i = 0; i < 2; i++) {
+        const double p = bumping.winProbability(i);
+        const double error = std::sqrt(p * (1.0 - p) / games);
+        check::near(simulated[i], p, 4.0 * error, "simulated seat " + std::to_string(i) + " wins with bumping");
+    }
+    check::that(std::abs(bumping.winProbability(0) - RaceAnalysis(chain, 2).winProbability(0)) > 1e-4,
+        "bumping changes the race");
+    return check::result("jointChain");
+}
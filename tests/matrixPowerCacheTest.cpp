@@ -0,0 +1,45 @@
+#include <vector>
+#include <algorithm>
+#include "check.hpp"
+#include "matrixPowerCache.hpp"
+#include "canonicalBoards.hpp"
+
+// distributions from cached squares against exact step-by-step evolution
+
+// max |pi_cache(k) - pi(k)| for k = 0 .. turns, pi stepped with the sparse P
+double worstDifference(MatrixPowerCache& cache, const TransitionMatrix& chain, int turns) {
+    const SparseMatrix<double>& P = chain.getSparseTransitionMatrix();
+    const int states = P.getRows();
+    std::vector<double> pi(states, 0.0), next(states);
+    pi[0] = 1.0;
+    double worst = 0.0;
+    for (int k = 0; k <= turns; k++) {
+        const std::vector<double> cached = cache.distribution(0, k);
+        for (int i = 0; i < states; i++)
+            worst = std::max(worst, std::abs(cached[i] - pi[i]));
+        P.multiplyTranspose(pi.data(), next.data());
+        pi.swap(next);
+    }
+    return worst;
+}
+
+int main() {
+    TransitionMatrix chain(boards::toJumpTable<100>(boards::classicJumps));
+    chain.calculateProbabilities();
+
+    MatrixPowerCache cache(chain);
+    check::near(worstDifference(cache, chain, 600), 0.0, 1e-12, "distributions up to 600 turns");
+    check::that(cache.getHits() > cache.getMisses(), "squares are reused");
+    check::near(cache.winProbability(0, 100), boards::classic.winProbability[100], 1e-12, "win probability after 100 turns");
+    check::near(cache.winProbability(0, 1000000000000000000ULL), 1.0, 1e-12, "win probability after 10^18 turns");
+
+    // room for P and two squares only: evicted squares are rebuilt
+    const std::size_t bytes = 100 * static_cast<std::size_t>(cache.power(0).getStride()) * sizeof(double);
+    MatrixPowerCache small(chain, 3 * bytes);
+    check::near(worstDifference(small, chain, 300), 0.0, 1e-12, "distributions with evictions");
+    check::that(small.memoryUsage() <= small.getMemoryLimit(), "memory limit is kept");
+    check::that(small.cachedPowers() <= 3, "at most three squares cached");
+
+    check::throws<std::invalid_argument>([&]() { MatrixPowerCache tiny(chain, 1000); }, "a limit below three matrices");
+    return check::result("matrixPowerCache");
+}
@@ -0,0 +1,40 @@
+#include <vector>
+#include "check.hpp"
+#include "raceAnalysis.hpp"
+#include "canonicalBoards.hpp"
+
+// the independent-race formulas against simulated races
+
+int main() {
+    TransitionMatrix chain(boards::toJumpTable<100>(boards::classicJumps));
+    chain.calculateProbabilities();
+
+    const RaceAnalysis solo(chain, 1);
+    check::near(solo.winProbability(0), 1.0, 1e-10, "a single player always wins");
+    check::near(solo.getExpectedRounds(), chain.getExpectedMoves()[0][0], 1e-8, "one player's rounds are its moves");
+
+    for (int players : {2, 4}) {
+        const std::string name = std::to_string(players) + " players";
+        const RaceAnalysis race(chain, players);
+        double total = race.unresolvedProbability();
+        for (double p : race.getWinProbabilities())
+            total += p;
+        check::near(total, 1.0, 1e-10, name + " win probabilities and the unresolved tail sum to one");
+        check::that(race.winProbability(0) > race.winProbability(players - 1), name + " moving first is an advantage");
+
+        const RaceSimulationResult simulated = race.simulate(400000, 7);
+        check::that(race.maxDeviation(simulated) < 4.0, name + " simulated seat wins within 4 standard errors");
+        check::near(simulated.meanRounds, race.getExpectedRounds(), 0.1, name + " simulated rounds");
+        check::near(simulated.meanMoves, race.getExpectedMoves(), 0.3, name + " simulated moves");
+
+        // game g always draws the same dice, however the games are split
+        const RaceSimulationResult again = race.simulate(400000, 7, 3);
+        check::that(again.seatWins == simulated.seatWins, name + " simulation independent of the thread count");
+    }
+
+    // a head start on block 10 for the second seat
+    const RaceAnalysis handicap(chain, std::vector<int>{0, 10});
+    check::that(handicap.maxDeviation(handicap.simulate(400000, 3)) < 4.0, "handicap race simulated seat wins");
+    check::throws<std::invalid_argument>([&]() { RaceAnalysis empty(chain, 0); }, "a race without players");
+    return check::result("raceAnalysis");
+}
@@ -0,0 +1,41 @@
+#include <cmath>
+#include <algorithm>
+#include "check.hpp"
+#include "spectralTail.hpp"
+#include "absorptionTime.hpp"
+#include "canonicalBoards.hpp"
+
+// the geometric tail model against exact stepping far into the tail
+
+template <std::size_t N>
+void compareWithStepping(const std::array<boards::Jump, N>& jumps, const std::string& name) {
+    TransitionMatrix chain(boards::toJumpTable<100>(jumps));
+    chain.calculateProbabilities();
+    const SpectralTailModel model(chain, 0);
+    const AbsorptionTimeDistribution exact(chain, 0, 1e-300, 5000);
+
+    // the ratio of consecutive survival terms tends to the dominant eigenvalue
+    const int late = std::min(exact.horizon() - 1, 1000);
+    check::near(exact.survival(late + 1) / exact.survival(late), model.dominantEigenvalue(), 1e-9,
+        name + " dominant eigenvalue");
+    check::that(model.subdominantModulus() < model.dominantEigenvalue(), name + " dominant eigenvalue is separated");
+
+    double worst = 0.0;
+    for (int k = model.anchor(); k <= exact.horizon() && exact.survival(k) > 1e-290; k++)
+        worst = std::max(worst, std::abs(model.survival(k) - exact.survival(k)) / exact.survival(k));
+    check::that(worst <= model.relativeErrorBound(), name + " tail error within the reported bound");
+    check::near(worst, 0.0, 1e-8, name + " relative tail error");
+
+    // the turn count for a survival level brackets it exactly
+    for (double p : {1e-3, 1e-9, 1e-100}) {
+        const long long k = model.turnsUntilSurvivalBelow(p);
+        check::that(model.survival(k) <= p && model.survival(k - 1) > p, name + " turns until survival below a level");
+    }
+    check::near(model.logSurvival(300), std::log(model.survival(300)), 1e-9, name + " log survival");
+}
+
+int main() {
+    compareWithStepping(boards::classicJumps, "classic");
+    compareWithStepping(boards::emptyJumps, "empty");
+    return check::result("spectralTail");
+}
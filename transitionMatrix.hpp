@@ -2,64 +2,88 @@
 #include <vector>
 #include <fstream>
 #include "board.hpp"
+#include "jumpTable.hpp"
+#include "moveRules.hpp"
 #include "matrix.hpp"
+#include "sparseMatrix.hpp"
+#include "luFactorization.hpp"
+#include "profileSolver.hpp"
+#include <optional>
 
 class TransitionMatrix {
-    /* matrix is a 2D vector of size totalStates x totalStates
+    /* matrix is a totalStates x totalStates sparse (CSR) matrix
      this is a representation of the first order markov model
      where each state has a probability of transitioning to every
-     other state*/
-    std::vector<std::vector<double>> matrix;
-    std::vector<std::vector<BoardEntity*>> board;
-    int boardLength;
+     other state; a row has at most six non-zeros (one per dice face)
+     so only those are stored */
+    SparseMatrix<double> matrix;
+    // destination of every block after snakes / ladders
+    JumpTable jumps;
     int totalStates;
 
-    std::pair<int, int> nonLineariseBlock(int block) {
-        int row = block / boardLength;
-        int col = block % boardLength;
-        
-        return std::make_pair(row, col);
+    // LU of (I - Q), built on first use and shared by every
+    // fundamental-matrix query until the probabilities change
+    std::optional<LUFactorization<double>> fundamentalLU;
+
+    // profile / banded solvers of (I - Q) and (I - Q)^T on the CSR form,
+    // the dense LU is only the fallback when they meet a zero pivot
+    std::optional<BandedSolver> sparseSolver, sparseTransposeSolver;
+    bool sparseFailed = false;
+
+    // solves (I - Q) x = b, or (I - Q)^T x = b when transposed
+    Matrix<double> solveIMinusQ(const std::vector<double>& b, bool transposed) {
+        std::optional<BandedSolver>& solver = transposed ? sparseTransposeSolver : sparseSolver;
+        if (!solver && !sparseFailed) {
+            try {
+                SparseMatrix<double> IMinusQ = getSparseIMinusQ();
+                solver.emplace(transposed ? IMinusQ.transpose() : IMinusQ);
+            } catch (const std::runtime_error&) {
+                sparseFailed = true;
+            }
+        }
+
+        Matrix<double> x(static_cast<int>(b.size()), 1);
+        if (solver) {
+            std::vector<double> result = solver->solve(b);
+            for (int i = 0; i < x.getRows(); i++)
+                x[i][0] = result[i];
+            return x;
+        }
+
+        for (int i = 0; i < x.getRows(); i++)
+            x[i][0] = b[i];
+        const LUFactorization<double>& lu = getFundamentalLU();
+        return transposed ? lu.solveTranspose(x) : lu.solve(x);
     }
 
     void calculateTransitionProbs(int block) {
         // for every possible dice state (0 - 6), curr block transition
-        // probabilities are calculated and put into the matrix
+        // probabilities are calculated and appended as the next row
         const double rollProb = 1.0/6.0;
-
-        for (int dice = 1; dice <= 6; dice +=1) {
-            int nextBlock = block + dice;
-            int finalDestination;
-            
-            // CASE 1: overshooting the total states
-            if (nextBlock > totalStates - 1) {
-                finalDestination = block;
-            }
-
-            // CASE 2: winning block
-            else if (nextBlock == totalStates - 1) {
-                finalDestination = nextBlock;
-            }
-
-            else {
-                auto [row, col] = nonLineariseBlock(nextBlock);
-                // CASE 3: Snake / Ladder
-                if (board[row][col] != nullptr)
-                    finalDestination = board[row][col]->getTargetBlock();
-                else // CASE 4: empty
-                    finalDestination = nextBlock;
-            }
-
-            matrix[block][finalDestination] += rollProb;
-        }
+        std::vector<std::pair<int, double>> row;
+        row.reserve(6);
+
+        // overshooting stays put, the winning block is its own
+        // destination, otherwise snake / ladder or the block itself
+        for (int dice = 1; dice <= 6; dice +=1)
+            row.emplace_back(rules::moveDestination(block, dice, totalStates, jumps), rollProb);
+        // repeated destinations are summed by appendRow
+        matrix.appendRow(row);
     }
 
     public:
-    TransitionMatrix(std::vector<std::vector<BoardEntity*>> b, int s, int l)
-        : board(b), totalStates(s), boardLength(l),
-        // initialised with 0
-        matrix(s, std::vector<double>(s, 0)) {}
+    TransitionMatrix(const std::vector<std::vector<BoardEntity*>>& b, int s, int l)
+        : matrix(s, s), jumps(JumpTable::fromGrid(b, l)), totalStates(s) {}
+
+    explicit TransitionMatrix(const JumpTable& table)
+        : matrix(table.size(), table.size()), jumps(table), totalStates(table.size()) {}
 
     void calculateProbabilities() {
+        fundamentalLU.reset();
+        sparseSolver.reset();
+        sparseTransposeSolver.reset();
+        sparseFailed = false;
+        matrix = SparseMatrix<double>(totalStates, totalStates);
         for (int i =0; i < totalStates; i++)
             calculateTransitionProbs(i);
     }
@@ -67,9 +91,15 @@ class TransitionMatrix {
     void exportToCSV(const std::string& filename) {
         std::ofstream file(filename);
 
+        std::vector<double> denseRow(totalStates);
         for (int i = 0; i<totalStates; i+=1) {
+            std::fill(denseRow.begin(), denseRow.end(), 0.0);
+            SparseMatrix<double>::Row r = matrix.row(i);
+            for (int k = 0; k < r.size(); k++)
+                denseRow[r.col(k)] = r.value(k);
+
             for (int j=0; j< totalStates; j+=1) {
-                file << matrix[i][j];
+                file << denseRow[j];
                 if (j < totalStates - 1) 
                     file << ",";
             }
@@ -79,47 +109,114 @@ class TransitionMatrix {
         
     }
 
-    Matrix<double> getTransitionMatrix() {
-        return Matrix<double>(matrix);
+    // dense copy of P, built for the caller and not kept
+    Matrix<double> getTransitionMatrix() const {
+        return matrix.toDense();
+    }
+
+    const JumpTable& getJumpTable() const {
+        return jumps;
+    }
+
+    const SparseMatrix<double>& getSparseTransitionMatrix() const {
+        return matrix;
+    }
+
+    // transient-to-transient block copied into its own CSR arrays, for
+    // loops that multiply by Q many times; getQView avoids the copy
+    SparseMatrix<double> getSparseQMatrix() const {
+        return matrix.leadingBlock(totalStates - 1, totalStates - 1);
+    }
+
+    // (I - Q) in CSR form, the system matrix of every absorbing-chain query
+    SparseMatrix<double> getSparseIMinusQ() const {
+        const SparseMatrix<double>::Block Q = getQView();
+        SparseMatrix<double> IMinusQ(Q.getRows(), Q.getCols());
+        std::vector<std::pair<int, double>> entries;
+        for (int i = 0; i < Q.getRows(); i++) {
+            entries.clear();
+            entries.emplace_back(i, 1.0);
+            SparseMatrix<double>::Row r = Q.row(i);
+            for (int k = 0; k < r.size(); k++)
+                entries.emplace_back(r.col(k), -r.value(k));
+            IMinusQ.appendRow(entries);
+        }
+        return IMinusQ;
     }
 
     // Transient states: from where transitioning to another states is possible
     // Absorbing state: final state / from where transitioning isn't possible
-    
-    Matrix<double> getQMatrix() {
-        // matrix with all the transient states only so:
-        // size: (totalStates - 1) x (totalStates - 1)
 
-        int transientStates = totalStates - 1;
-        Matrix<double> Q(transientStates, transientStates);
+    // views of Q and R over the CSR rows of P, nothing is copied; they
+    // stay valid across calculateProbabilities but not past this object
+    SparseMatrix<double>::Block getQView() const {
+        // transient states only, (totalStates - 1) x (totalStates - 1)
+        return matrix.block(0, 0, totalStates - 1, totalStates - 1);
+    }
+
+    SparseMatrix<double>::Block getRView() const {
+        // transient states to absorbing state, (totalStates - 1) x 1
+        return matrix.block(0, totalStates - 1, totalStates - 1, 1);
+    }
+
+    // dense copies built from the views for callers that need them
+    Matrix<double> getQMatrix() const {
+        return getQView().toDense();
+    }
 
-        for (int i = 0; i < transientStates; i++) {
-            for (int j = 0; j < transientStates; j++) {
-                Q[i][j] = matrix[i][j];
+    Matrix<double> getRMatrix() const {
+        return getRView().toDense();
+    }
+
+    // factorization of (I - Q), N = (I - Q)^-1 is never formed explicitly
+    // unless getFundamentalMatrix is called. I - Q is written straight
+    // from the CSR rows into the buffer the LU then factorizes in place
+    const LUFactorization<double>& getFundamentalLU() {
+        if (!fundamentalLU) {
+            const SparseMatrix<double>::Block Q = getQView();
+            Matrix<double> IMinusQ(Q.getRows(), Q.getCols(), 0.0);
+            for (int i = 0; i < Q.getRows(); i++) {
+                double *row = IMinusQ[i];
+                row[i] = 1.0;
+                SparseMatrix<double>::Row r = Q.row(i);
+                for (int k = 0; k < r.size(); k++)
+                    row[r.col(k)] -= r.value(k);
             }
+            fundamentalLU.emplace(std::move(IMinusQ));
         }
-        return Q;
+        return *fundamentalLU;
     }
 
-    Matrix<double> getRMatrix() {
-        // transient states to absorbing state only
-        // size: (totalStates - 1) x 1
-        int transientStates = totalStates - 1;
-        int absorbingState = totalStates - 1;
-        Matrix<double> R(transientStates, 1);
+    Matrix<double> getFundamentalMatrix() {
+        return getFundamentalLU().inverse();
+    }
+
+    // expected moves to win from each transient block: t = N x 1
+    Matrix<double> getExpectedMoves() {
+        return solveIMinusQ(std::vector<double>(totalStates - 1, 1.0), false);
+    }
 
-        for (int i=0; i< transientStates; i+=1) {
-            R[i][0] = matrix[i][absorbingState];
+    // probability of being absorbed from each transient block: B = N x R
+    Matrix<double> getAbsorptionProbabilities() {
+        const SparseMatrix<double>::Block R = getRView();
+        std::vector<double> r(R.getRows(), 0.0);
+        for (int i = 0; i < R.getRows(); i++) {
+            const SparseMatrix<double>::Row entry = R.row(i);
+            if (entry.size() > 0)
+                r[i] = entry.value(0);
         }
-        return R;
+        return solveIMinusQ(r, false);
     }
 
-    Matrix<double> getFundamentalMatrix() {
-        Matrix<double> Q = getQMatrix();
-        int N = Q.getRows(); // # of rows of Q
-        Matrix<double> I = Matrix<double>::identity(N);
-        Matrix<double> IMinusQ = I-Q;
+    // expected visits to every transient block when starting at startBlock,
+    // i.e. row startBlock of N, computed as N^T e_start
+    Matrix<double> getExpectedVisits(int startBlock) {
+        const int transientStates = totalStates - 1;
+        if (startBlock < 0 || startBlock >= transientStates)
+            throw std::out_of_range("Start block must be a transient state.");
 
-        return IMinusQ.inverse();
+        std::vector<double> e(transientStates, 0.0);
+        e[startBlock] = 1.0;
+        return solveIMinusQ(e, true);
     }
 };
\ No newline at end of file